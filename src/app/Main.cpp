@@ -1,6 +1,8 @@
 
 #include <iostream> 
 #include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <thread>
 
 #include "Window.h"
@@ -12,6 +14,8 @@ using namespace Brushlink;
 int main(int argc, char *argv[])
 {
 	std::cout << "startup" << std:: endl;
+	// --profile shows tick phase timings over the world and prints them after each game
+	bool profile = argc > 1 && strcmp(argv[1], "--profile") == 0;
 	Window window;
 	Input input;
 	while (!window.Closed())
@@ -25,12 +29,14 @@ int main(int argc, char *argv[])
 		std::cout << "new game" << std::endl;
 		Game game;
 		game.Initialize();
+		game.LoadGraphics();
+		game.profiler.show_overlay = profile;
 		input.listeners["game"].reset(MakeCurriedMember(&Game::ReceiveInput, game));
 		const auto game_start = std::chrono::steady_clock::now();
 		auto game_current = game_start;
 		auto tick_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
 			std::chrono::duration<double> {
-				1.0  / static_cast<double>(game.settings.speed.value)
+				1.0  / static_cast<double>(game.rules->speed.value)
 			}
 		);
 		auto next_tick = game_start;
@@ -69,6 +75,10 @@ int main(int argc, char *argv[])
 		}
 		input.listeners.erase("game");
 		std::cout << "game over" << std::endl;
+		if (profile)
+		{
+			game.profiler.Dump(stdout);
+		}
 	
 	}
 
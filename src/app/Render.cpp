@@ -0,0 +1,373 @@
+#include "Game.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+#include <utility>
+
+#include "tigr.h"
+
+#include "Input.h"
+
+// everything that draws the game or reads images
+// only the windowed app compiles this, so headless builds don't link tigr
+
+namespace Brushlink
+{
+
+void Game::LoadGraphics()
+{
+	std::shared_ptr<Tigr> palettes_image{
+		tigrLoadImage(settings.palettes_image_file.c_str()),
+		TigrDeleter{}};
+	for (auto & [id, player] : players)
+	{
+		for (auto & graphics : player.data->graphical_preferences)
+		{
+			if (!palettes_image
+				|| graphics.palette.type == Palette_Type::SingleColor
+				|| graphics.palette.type == Palette_Type::Custom)
+			{
+				continue;
+			}
+			for (int i = 0; i < palettes_image->w; i++)
+			{
+				graphics.palette.colors[i] = tigrGet(
+					palettes_image.get(),
+					i,
+					static_cast<int>(graphics.palette.type)
+				);
+				printf("%08x\n", Pack(graphics.palette.colors[i]));
+				//std::cout << std::bitset<32>{Pack(graphics.palette.colors[i])} << std::endl;
+			}
+		}
+		player.graphics = player.data->graphical_preferences.front();
+		world.player_graphics[id] = player.graphics;
+	}
+	world.energy_bars.reset(tigrLoadImage(settings.energy_image_file.c_str()), TigrDeleter{});
+	std::shared_ptr<Tigr> units_image{tigrLoadImage(settings.units_image_file.c_str()), TigrDeleter{}};
+	int px = world.settings.tile_px;
+	int color_count = settings.palette_replace_colors.size();
+	std::vector<uint> packed_colors;
+	for(auto & color : settings.palette_replace_colors)
+	{
+		packed_colors.push_back(Pack(color));
+	}
+	for (auto & [unit_type, unit_settings] : settings.unit_types)
+	{
+		for (auto & [player_id, graphics] : world.player_graphics)
+		{
+			auto & bodies = world.unit_bodies[graphics];
+			if (bodies[static_cast<int>(unit_type)])
+			{
+				// players with the same graphics share bodies
+				continue;
+			}
+			if (graphics.palette.color_count < color_count)
+			{
+				Error("Player Palette doesn't have enough colors").Log();
+				continue;
+			}
+			std::shared_ptr<Tigr> body {tigrBitmap(px, px), TigrDeleter{}};
+			tigrBlit(body.get(),
+				units_image.get(),
+				0, 0, // dest x,y
+				px * static_cast<int>(unit_type),
+				px * static_cast<int>(graphics.pattern),
+				px, px // size
+			);
+			for (int x = 0; x < px; x++)
+			{
+				for (int y = 0; y < px; y++)
+				{
+					uint packed_color = Pack(body->pix[y*px+x]);
+					for (int color_index = 0; color_index < color_count; color_index++)
+					{
+						if (packed_color == packed_colors[color_index])
+						{
+							body->pix[y*px+x] = graphics.palette.colors[color_index];
+						}
+					}
+				}
+			}
+			bodies[static_cast<int>(unit_type)] = body;
+		}
+	}
+}
+
+void Game::Render(Tigr * screen, const Dimensions & world_portion)
+{
+	{
+		Scoped_Timer timer{profiler, Profile_Phase::Render};
+		world.Render(screen, world_portion, players[local_player].camera_location, local_player);
+	}
+	// todo: render command card, buffer
+	if (profiler.show_overlay)
+	{
+		profiler.DrawOverlay(screen, world_portion.x + 2, world_portion.y + 2);
+	}
+}
+
+Input_Result Game::ReceiveInput(
+	const Key_Changes &,
+	const Modifiers_State &,
+	const Mouse_State &,
+	const std::vector<Point> &)
+{
+	return Input_Result::NoUpdateNeeded;
+}
+
+void World::Render(Tigr* screen, Dimensions screen_space, Point camera_bottom_left, PlayerID player)
+{
+	render_frame++;
+	RenderTerrain(screen, screen_space, camera_bottom_left);
+
+	// render units
+	int energy_granularity = energy_bars->w / settings.tile_px;
+	auto Get_Screen_Space_Offset = [&](Point position)
+	{
+		// todo: reconcile screen/world space up
+		Point screen_space_offset = position - camera_bottom_left;
+		screen_space_offset.x *= settings.tile_px;
+		screen_space_offset.y *= settings.tile_px;
+		return screen_space_offset;
+	};
+
+	auto Trim_Source_Dimensions = [&](
+		Dimensions source_dim,
+		Point screen_space_offset)
+	{
+		if (screen_space_offset.x < 0)
+		{
+			source_dim.x -= screen_space_offset.x;
+			source_dim.width += screen_space_offset.x;
+		}
+		if (screen_space_offset.y < 0)
+		{
+			source_dim.y -= screen_space_offset.x;
+			source_dim.width += screen_space_offset.x;
+		}
+		source_dim.width = std::min(source_dim.width,
+			screen_space.width - screen_space_offset.x);
+		source_dim.height = std::min(source_dim.height,
+			screen_space.height - screen_space_offset.y);
+		return source_dim;
+	};
+
+	auto Render_Unit = [&](const Unit & unit)
+	{
+		// @Feature interpolate position while moving
+		Tigr * body = unit_bodies[player_graphics[unit.player]][static_cast<int>(unit.type->type)].get();
+		Point screen_space_offset = Get_Screen_Space_Offset(unit.position);
+		Dimensions sprite_source = Trim_Source_Dimensions(
+			Dimensions{0, 0, body->w, body->h},
+			screen_space_offset
+		);
+
+		if (sprite_source.width <= 0
+			|| sprite_source.height <= 0)
+		{
+			// this unit is not on screen, do not render
+			return;
+		}
+		tigrBlitAlpha(
+			screen,
+			body,
+			screen_space.x + screen_space_offset.x,
+			screen_space.y + screen_space_offset.y,
+			sprite_source.x,
+			sprite_source.y,
+			sprite_source.width,
+			sprite_source.height,
+			1.0);
+
+		// energy bar
+		float energy_ratio = static_cast<float>(unit.energy.value)
+			/ static_cast<float>(unit.type->max_energy.value);
+		int energy_index = energy_ratio * (energy_granularity - 1);
+		if (energy_ratio < 0.001)
+		{
+			energy_index = 0;
+		}
+		else if (energy_index == 0)
+		{
+			// empty is reserved for 0 or less
+			// so anything more than .001 has a little visible
+			energy_index = 1;
+		}
+		else if (energy_ratio > 0.999)
+		{
+			energy_index = energy_granularity - 1;
+		}
+		Dimensions energy_source = Trim_Source_Dimensions(
+			Dimensions{
+				energy_index * settings.tile_px,
+				0,
+				settings.tile_px,
+				settings.tile_px // consider copying a subset of the tile
+			},
+			screen_space_offset
+		);
+		tigrBlitAlpha(
+			screen,
+			energy_bars.get(),
+			screen_space.x + screen_space_offset.x,
+			screen_space.y + screen_space_offset.y,
+			energy_source.x,
+			energy_source.y,
+			energy_source.width,
+			energy_source.height,
+			1.0); 
+	};
+
+	const Vision_Map * found_vision = FindVision(player);
+	const Vision_Map & player_vision = found_vision != nullptr
+		? *found_vision
+		: GetVision(player);
+
+	for(const Unit & unit : std::as_const(units))
+	{
+		// don't render units that are out of vision range
+		if(unit.player != player
+			&& !player_vision.IsVisible(unit.position))
+		{
+			continue;
+		}
+		Render_Unit(unit);
+	}
+
+	// @Feature ability fx
+
+	// render fog
+	RenderFog(screen, screen_space, camera_bottom_left, player_vision);
+}
+
+void World::RenderFog(Tigr* screen, Dimensions screen_space, Point camera_bottom_left, const Vision_Map & vision)
+{
+	// scale the per-tile mask up to tile_px while blending, one pass over the viewport
+	const int px = settings.tile_px;
+	const TPixel fog = settings.fog_color;
+	int first_row = std::max(0, -screen_space.y);
+	int last_row = std::min(screen_space.height, screen->h - screen_space.y);
+	int first_column = std::max(0, -screen_space.x);
+	int last_column = std::min(screen_space.width, screen->w - screen_space.x);
+	for (int row = first_row; row < last_row; row++)
+	{
+		int tile_y = camera_bottom_left.y + row / px;
+		TPixel * pixels = screen->pix + (screen_space.y + row) * screen->w + screen_space.x;
+		int column = first_column;
+		while (column < last_column)
+		{
+			int tile_x = camera_bottom_left.x + column / px;
+			int tile_end = std::min(last_column, (column / px + 1) * px);
+			int alpha = vision.fog_mask.Get({tile_x, tile_y}) * fog.a / 255;
+			if (alpha > 0)
+			{
+				for (; column < tile_end; column++)
+				{
+					TPixel & pixel = pixels[column];
+					pixel.r += (fog.r - pixel.r) * alpha / 255;
+					pixel.g += (fog.g - pixel.g) * alpha / 255;
+					pixel.b += (fog.b - pixel.b) * alpha / 255;
+				}
+			}
+			column = tile_end;
+		}
+	}
+}
+
+
+void World::RenderTerrain(Tigr* screen, Dimensions screen_space, Point camera_bottom_left)
+{
+	const int px = settings.tile_px;
+	const int chunk_px = World_Chunk::size * px;
+	// viewport in terrain pixel space, clipped to the world
+	int view_left = camera_bottom_left.x * px;
+	int view_bottom = camera_bottom_left.y * px;
+	int left = std::max(view_left, 0);
+	int bottom = std::max(view_bottom, 0);
+	int right = std::min(view_left + screen_space.width, chunks.width * px);
+	int top = std::min(view_bottom + screen_space.height, chunks.height * px);
+	for (int chunk_y = bottom / chunk_px; chunk_y * chunk_px < top; chunk_y++)
+	{
+		for (int chunk_x = left / chunk_px; chunk_x * chunk_px < right; chunk_x++)
+		{
+			World_Chunk & chunk = chunks.GetChunkForDrawing({
+				chunk_x * World_Chunk::size,
+				chunk_y * World_Chunk::size});
+			if (!chunk.drawn_terrain)
+			{
+				DrawChunkTerrain(chunk);
+			}
+			chunk.last_drawn_frame = render_frame;
+			int source_left = std::max(left, chunk_x * chunk_px);
+			int source_bottom = std::max(bottom, chunk_y * chunk_px);
+			int source_right = std::min(right, (chunk_x + 1) * chunk_px);
+			int source_top = std::min(top, (chunk_y + 1) * chunk_px);
+			tigrBlit(
+				screen,
+				chunk.drawn_terrain.get(),
+				screen_space.x + source_left - view_left,
+				screen_space.y + source_bottom - view_bottom,
+				source_left - chunk_x * chunk_px,
+				source_bottom - chunk_y * chunk_px,
+				source_right - source_left,
+				source_top - source_bottom);
+		}
+	}
+
+	// drop rasterized terrain that hasn't been on screen for a while
+	const int keep_frames = 120;
+	for (auto & chunk : chunks.chunks)
+	{
+		if (chunk
+			&& chunk->drawn_terrain
+			&& render_frame - chunk->last_drawn_frame > keep_frames)
+		{
+			chunk->drawn_terrain.reset();
+		}
+	}
+}
+
+void World::DrawChunkTerrain(World_Chunk & chunk)
+{
+	const int px = settings.tile_px;
+	chunk.drawn_terrain.reset(
+		tigrBitmap(World_Chunk::size * px, World_Chunk::size * px),
+		TigrDeleter{});
+	for (int y = 0; y < World_Chunk::size; y++)
+	{
+		for (int x = 0; x < World_Chunk::size; x++)
+		{
+			Point tile = chunk.origin + Point{x, y};
+			tigrFill(chunk.drawn_terrain.get(),
+				x * px, y * px, px, px,
+				chunk.terrain[World_Chunk::TileIndex(tile)] == 0
+					? settings.checker_colors.first
+					: settings.checker_colors.second);
+		}
+	}
+}
+
+void Profiler::DrawOverlay(Tigr * screen, int x, int y) const
+{
+	const TPixel color {255, 255, 255, 255};
+	const int line_height = 10;
+	tigrPrint(screen, tfont, x, y, color, "phase us  mean / p99 / max");
+	for (int i = 0; i < profile_phase_count; i++)
+	{
+		Profile_Stats stats = phases[i].Compute();
+		if (stats.samples == 0)
+		{
+			continue;
+		}
+		y += line_height;
+		tigrPrint(screen, tfont, x, y, color, "%s %.0f / %.0f / %.0f",
+			GetName(static_cast<Profile_Phase>(i)),
+			stats.mean_us,
+			stats.p99_us,
+			stats.max_us);
+	}
+}
+
+} // namespace Brushlink
@@ -69,6 +69,7 @@ const Table<Variant_Type, int> default_tab_type_indexes{
 
 	{Variant_Type::Action_Type, 4}, // implicitly creates a Step of Type
 	{Variant_Type::Action_Step, 4},
+	{Variant_Type::Event_Type, 4}, // named after the actions that cause most of them
 
 	{Variant_Type::Unit_Type, 5},
 	{Variant_Type::Unit_Attribute, 5},
@@ -88,6 +89,26 @@ const Table<Variant_Type, int> default_tab_type_indexes{
 
 const std::string horizontal_line = "––––––––––––––––––––––––––––––––––––––––";
 
+const Brushlink::Seconds preview_length{3.0};
+
+// units owned by the player, then by everyone else
+std::pair<int, int> CountUnits(const Brushlink::Game & game, Brushlink::PlayerID player)
+{
+	std::pair<int, int> counts{0, 0};
+	for (const Brushlink::Unit & unit : game.world.units)
+	{
+		if (unit.player == player)
+		{
+			counts.first++;
+		}
+		else
+		{
+			counts.second++;
+		}
+	}
+	return counts;
+}
+
 // @Feature different default_hotkeys for numbers of columns/rows
 
 CardBuilder::CardBuilder(Context & context)
@@ -211,6 +232,7 @@ ErrorOr<Success> CardBuilder::HandleToken(ElementToken token)
 	));
 	BreakUndoChain(token);
 	RefreshAllowedTypes();
+	StartPreview();
 	// feels a little weird to preempt adding 1 inside of Repeat...
 	priority_next_count = -1;
 	RepeatTabOperationUntilContainsAllowed(TabNav::NextHighestPriority);
@@ -241,6 +263,27 @@ ErrorOr<Success> CardBuilder::HandleInstruction(Instruction instruction)
 }
 
 
+void CardBuilder::StartPreview()
+{
+	if (context.game == nullptr || context.player == nullptr)
+	{
+		return;
+	}
+	value_ptr<Element> built = command;
+	Brushlink::PlayerID player = context.player->id;
+	preview_start_counts = CountUnits(*context.game, player);
+	preview.Start(
+		*context.game,
+		context.game->SecondsToTicks(preview_length).value,
+		[built, player](Brushlink::Game & snapshot)
+		{
+			// an unfinished command is expected to fail to evaluate
+			// the preview then just shows the game carrying on without it
+			// so the error is dropped rather than logged on every keystroke
+			(void)built->Evaluate(snapshot.players.at(player).root_command_context);
+		});
+}
+
 ErrorOr<Success> CardBuilder::InitNewCommand()
 {
 	command = CHECK_RETURN(GetNewCommandElement({"Command"}));
@@ -644,6 +687,20 @@ std::string CardBuilder::MakeCurrentTabPrintString()
 
 		output += "\n";
 	}
+
+	if (const Brushlink::Game * result = preview.Result())
+	{
+		auto [owned, enemies] = CountUnits(*result, context.player->id);
+		auto Change = [](int now, int before)
+		{
+			return (now >= before ? " (+" : " (") + std::to_string(now - before) + ")";
+		};
+		output += horizontal_line + "\n";
+		output += "In " + std::to_string(static_cast<int>(preview_length.value)) + "s"
+			+ "\tunits " + std::to_string(owned) + Change(owned, preview_start_counts.first)
+			+ "\tenemies " + std::to_string(enemies) + Change(enemies, preview_start_counts.second)
+			+ "\n";
+	}
 	return output;
 }
 
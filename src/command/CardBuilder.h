@@ -7,6 +7,7 @@
 #include "Context.h"
 #include "Element.hpp"
 #include "Dictionary.h"
+#include "Game_Preview.h"
 
 namespace Command
 {
@@ -43,6 +44,10 @@ struct CardBuilder
 	std::vector<ElementToken> undo_stack;
 	int undo_count;
 	std::vector<std::string> action_log;
+	// what the command so far would do, restarted after every appended element
+	// and shown below the card as the change in unit counts
+	Brushlink::Game_Preview preview;
+	std::pair<int, int> preview_start_counts;
 
 	CardBuilder(Context & context);
 
@@ -67,6 +72,7 @@ struct CardBuilder
 	ErrorOr<Success> PerformRedo();
 	void BreakUndoChain(ElementToken token);
 	ErrorOr<Success> AppendElement(value_ptr<Element>&& next);
+	void StartPreview();
 
 	static std::vector<ElementToken> MakeTokensFromDictionary(Dictionary dict);
 };
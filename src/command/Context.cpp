@@ -3,6 +3,8 @@
 #include "Game.h"
 #include "Player.h"
 
+#include <utility>
+
 namespace Command
 {
 
@@ -73,16 +75,155 @@ ErrorOr<std::vector<Variant>> Context::GetNamedValue(ValueName name)
 	return Error("No value found with name " + name.value);
 }
 
-ErrorOr<Brushlink::Unit &> GetUnit(Brushlink::UnitID id)
+ErrorOr<Ref<const Brushlink::Unit>> Context::GetUnit(Brushlink::UnitID id)
 {
-	if (Contains(game->world.units, id))
+	const Brushlink::Unit * unit = std::as_const(game->world).GetUnit(id);
+	if (unit == nullptr)
 	{
-		return game->world.units[id];
+		return Error("InvalidID");
 	}
-	else
+	return Ref<const Brushlink::Unit>{*unit};
+}
+
+ErrorOr<Unit_Group> Context::GetVisibleEnemies()
+{
+	if (game == nullptr || player == nullptr)
 	{
-		return Error("InvalidID");
+		return Error("Context has no game or player");
+	}
+	Unit_Group enemies;
+	const Brushlink::Vision_Map * vision = game->world.FindVision(player->id);
+	if (vision == nullptr)
+	{
+		return enemies;
+	}
+	for (auto id : game->world.spatial_index.WithinArea(
+		vision->visible,
+		{Brushlink::Player_Filter::Not_Owned_By, player->id}))
+	{
+		enemies.members.insert(id);
+	}
+	return enemies;
+}
+
+// the spatial queries only find other players' units this player can see
+
+ErrorOr<Unit_Group> Context::GetUnitsWithinRange(Point center, Number range)
+{
+	if (game == nullptr || player == nullptr)
+	{
+		return Error("Context has no game or player");
+	}
+	// uses the same circle stencils as vision
+	Unit_Group within_range;
+	for (auto id : game->world.spatial_index.WithinRadius(
+		center,
+		static_cast<float>(range.value),
+		game->world.SeenBy(player->id)))
+	{
+		within_range.members.insert(id);
+	}
+	return within_range;
+}
+
+ErrorOr<Unit_Group> Context::GetEnemiesWithinRange(Point center, Number range)
+{
+	if (game == nullptr || player == nullptr)
+	{
+		return Error("Context has no game or player");
+	}
+	Unit_Group within_range;
+	for (auto id : game->world.spatial_index.WithinRadius(
+		center,
+		static_cast<float>(range.value),
+		game->world.SeenBy(player->id, Brushlink::Player_Filter::Not_Owned_By)))
+	{
+		within_range.members.insert(id);
+	}
+	return within_range;
+}
+
+ErrorOr<Unit_Group> Context::GetUnitsInBox(Point bottom_left, Point top_right)
+{
+	if (game == nullptr || player == nullptr)
+	{
+		return Error("Context has no game or player");
+	}
+	Unit_Group in_box;
+	for (auto id : game->world.spatial_index.WithinBox(
+		bottom_left,
+		top_right,
+		game->world.SeenBy(player->id)))
+	{
+		in_box.members.insert(id);
+	}
+	return in_box;
+}
+
+ErrorOr<Unit_Group> Context::GetNearestEnemies(Point center, Number count)
+{
+	if (game == nullptr || player == nullptr)
+	{
+		return Error("Context has no game or player");
+	}
+	Unit_Group nearest;
+	for (auto id : game->world.spatial_index.Nearest(
+		center,
+		count.value,
+		game->world.SeenBy(player->id, Brushlink::Player_Filter::Not_Owned_By)))
+	{
+		nearest.members.insert(id);
+	}
+	return nearest;
+}
+
+ErrorOr<Unit_Group> Context::GetUnitsWithEvent(Brushlink::Event_Type type)
+{
+	if (game == nullptr || player == nullptr)
+	{
+		return Error("Context has no game or player");
 	}
+	// the previous tick is complete, the current one is still being written
+	Brushlink::Event_Filter filter = Brushlink::Event_Filter::Only(type);
+	filter.player = player->id;
+	Unit_Group actors;
+	bool complete = game->events.ReadTick(
+		Brushlink::Ticks{game->tick.value - 1},
+		filter,
+		[&](const Brushlink::Game_Event & event)
+		{
+			actors.members.insert(event.actor);
+		});
+	if (!complete)
+	{
+		return Error("Some of the last tick's events were overwritten");
+	}
+	return actors;
+}
+
+ErrorOr<Unit_Group> Context::GetUnitsTargetedBy(Brushlink::Event_Type type)
+{
+	if (game == nullptr || player == nullptr)
+	{
+		return Error("Context has no game or player");
+	}
+	Unit_Group targets;
+	bool complete = game->events.ReadTick(
+		Brushlink::Ticks{game->tick.value - 1},
+		Brushlink::Event_Filter::Only(type),
+		[&](const Brushlink::Game_Event & event)
+		{
+			const Brushlink::Unit * target = std::as_const(game->world).GetUnit(event.target);
+			if (target != nullptr && target->player == player->id)
+			{
+				targets.members.insert(event.target);
+			}
+		});
+	if (!complete)
+	{
+		return Error("Some of the last tick's events were overwritten");
+	}
+	return targets;
 }
 
 ErrorOr<Success> Context::Recurse()
@@ -139,7 +280,7 @@ ErrorOr<std::vector<Variant>> Context::SetLocal(ValueName name, std::vector<Vari
 	{
 		if (parent)
 		{
-			return parent->SetLocal(name, element);
+			return parent->SetLocal(name, value);
 		}
 		return Error("Context parent is unexpectedly null");
 	}
@@ -149,14 +290,23 @@ ErrorOr<std::vector<Variant>> Context::SetGlobal(ValueName name, std::vector<Var
 {
 	if (scope == Scope::Global)
 	{
+		auto found = values.find(name);
+		if (player != nullptr && found != values.end())
+		{
+			player->UnindexValue(name, found->second);
+		}
 		values[name] = value;
+		if (player != nullptr)
+		{
+			player->IndexValue(name, value);
+		}
 		return value;
 	}
 	else
 	{
 		if (parent)
 		{
-			return parent->SetGlobal(name, element);
+			return parent->SetGlobal(name, value);
 		}
 		return Error("Context parent is unexpectedly null");
 	}
@@ -6,6 +6,7 @@
 #include "Basic_Types.h"
 #include "Variant.h"
 #include "Unit.h"
+#include "Event.h"
 
 namespace Brushlink
 {
@@ -47,13 +48,23 @@ struct Context
 	Set<Variant_Type> GetAllowedWithImplied(Set<Variant_Type> allowed) const;
 	Context MakeChild(Scope new_scope);
 	ErrorOr<std::vector<Variant>> GetNamedValue(Brushlink::ValueName name);
-	ErrorOr<Ref<Brushlink::Unit>> GetUnit(Brushlink::UnitID id);
+	ErrorOr<Ref<const Brushlink::Unit>> GetUnit(Brushlink::UnitID id);
+	// enemy units in tiles this player can currently see
+	ErrorOr<Unit_Group> GetVisibleEnemies();
+	ErrorOr<Unit_Group> GetUnitsWithinRange(Point center, Number range);
+	ErrorOr<Unit_Group> GetEnemiesWithinRange(Point center, Number range);
+	ErrorOr<Unit_Group> GetUnitsInBox(Point bottom_left, Point top_right);
+	ErrorOr<Unit_Group> GetNearestEnemies(Point center, Number count);
+	// this player's units that were the actor of an event of this type last tick
+	ErrorOr<Unit_Group> GetUnitsWithEvent(Brushlink::Event_Type type);
+	// this player's units that were the target of an event of this type last tick
+	ErrorOr<Unit_Group> GetUnitsTargetedBy(Brushlink::Event_Type type);
 
 	// exposed functions
 	ErrorOr<Success> Recurse();
 	ErrorOr<Success> SetArgument(ValueName name, std::vector<Variant> value);
-	ErrorOr<Success> SetLocal(ValueName name, std::vector<Variant> value);
-	ErrorOr<Success> SetGlobal(ValueName name, std::vector<Variant> value);
+	ErrorOr<std::vector<Variant>> SetLocal(ValueName name, std::vector<Variant> value);
+	ErrorOr<std::vector<Variant>> SetGlobal(ValueName name, std::vector<Variant> value);
 	ErrorOr<Variant> GetLast(ValueName name);
 	ErrorOr<Variant> GetNth(ValueName name);
 	ErrorOr<Number> Count(ValueName name);
@@ -70,6 +70,14 @@ const Dictionary builtins = []
 	literal(Digit{7}, "Seven");
 	literal(Digit{8}, "Eight");
 	literal(Digit{9}, "Nine");
+	// past tense so they don't clash with the actions of the same name
+	literal(Event_Type::Spawn, "Spawned");
+	literal(Event_Type::Death, "Died");
+	literal(Event_Type::Attack, "Attacked");
+	literal(Event_Type::Heal, "Healed");
+	literal(Event_Type::Move, "Moved");
+	literal(Event_Type::Blocked, "Blocked");
+	literal(Event_Type::Command_Finished, "Finished_Command");
 	builtin_print(&NumberLiteral::Evaluate,
 		&NumberLiteral::Print,
 		R"(Builtin NumberLiteral Number
@@ -138,6 +146,7 @@ const Dictionary builtins = []
 	DECLARE_CAST_BUILTIN(Direction)
 	DECLARE_CAST_BUILTIN(Line)
 	DECLARE_CAST_BUILTIN(Area)
+	DECLARE_CAST_BUILTIN(Event_Type)
 
 	builtin(&Context::Get,
 		R"(Builtin Get Any
@@ -158,8 +167,32 @@ const Dictionary builtins = []
 		R"(Builtin CurrentSelection Unit_Group)");
 	builtin(&Context::Allies,
 		R"(Builtin Allies Unit_Group)");
-	builtin(&Context::Enemies,
+	builtin(&Context::GetVisibleEnemies,
 		R"(Builtin Enemies Unit_Group)");
+	// answered by the world's spatial index
+	builtin(&Context::GetUnitsWithinRange,
+		R"(Builtin UnitsWithinRange Unit_Group
+	Parameter center Point
+	Parameter range Number)");
+	builtin(&Context::GetEnemiesWithinRange,
+		R"(Builtin EnemiesWithinRange Unit_Group
+	Parameter center Point
+	Parameter range Number)");
+	builtin(&Context::GetUnitsInBox,
+		R"(Builtin UnitsInBox Unit_Group
+	Parameter bottom_left Point
+	Parameter top_right Point)");
+	builtin(&Context::GetNearestEnemies,
+		R"(Builtin NearestEnemies Unit_Group
+	Parameter center Point
+	Parameter count Number)");
+	// read from the previous tick's events
+	builtin(&Context::GetUnitsWithEvent,
+		R"(Builtin UnitsWithEvent Unit_Group
+	Parameter event Event_Type)");
+	builtin(&Context::GetUnitsTargetedBy,
+		R"(Builtin UnitsTargetedBy Unit_Group
+	Parameter event Event_Type)");
 	builtin(&Context::CommandGroup,
 		R"(Builtin CommandGroup Unit_Group
 	Parameter id Number)");
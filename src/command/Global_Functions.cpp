@@ -1,5 +1,7 @@
 #include "Global_Functions.h"
 
+#include "Circle_Stencil.h"
+
 namespace Command
 {
 
@@ -242,6 +244,17 @@ ErrorOr<Area> LocationConstructors::AreaUnion(std::vector<Area> areas)
 	return result;
 }
 
+ErrorOr<Area> LocationConstructors::AreaCircle(Point center, Number radius)
+{
+	if (radius.value < 0)
+	{
+		return Error("Circle radius can't be negative");
+	}
+	Area result;
+	Circle_Stencil::Get(static_cast<float>(radius.value)).StampInto(result, center);
+	return result;
+}
+
 ErrorOr<Point> LocationConstructors::PointAtAreaCenter(Area area)
 {
 	if (area.points.empty())
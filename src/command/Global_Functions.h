@@ -63,6 +63,7 @@ namespace LocationConstructors
 	ErrorOr<Line> LineFromPoints(std::vector<Point> points);
 	ErrorOr<Direction> DirectionFromTo(Point from, Point to);
 	ErrorOr<Area> AreaUnion(std::vector<Area> areas);
+	ErrorOr<Area> AreaCircle(Point center, Number radius);
 	ErrorOr<Point> PointAtAreaCenter(Area area);
 };
 
@@ -251,6 +251,7 @@ const Set<Token> types {
 	{TokenType::Element, "Direction"},
 	{TokenType::Element, "Line"},
 	{TokenType::Element, "Area"},
+	{TokenType::Element, "Event_Type"},
 };
 const Token builtin {TokenType::Element, "Builtin"};
 const Token function {TokenType::Element, "Function"};
@@ -6,6 +6,7 @@
 
 #include "Action.h"
 #include "Basic_Types.h"
+#include "Event.h"
 #include "Game_Basic_Types.h"
 #include "Game_Time.h"
 #include "Location.h"
@@ -39,7 +40,8 @@ using Variant = std::variant<
 	Point,
 	Direction,
 	Line,
-	Area>;
+	Area,
+	Event_Type>;
 
 enum class Variant_Type
 {
@@ -61,6 +63,7 @@ enum class Variant_Type
 	Direction,
 	Line,
 	Area,
+	Event_Type,
 	Any,
 };
 
@@ -83,6 +86,7 @@ const Set<Variant_Type> all_variant_types {
 	Variant_Type::Direction,
 	Variant_Type::Line,
 	Variant_Type::Area,
+	Variant_Type::Event_Type,
 	Variant_Type::Any,
 };
 
@@ -125,6 +129,8 @@ Variant_Type GetVariantType()
 		return Variant_Type::Line;
 	else if constexpr(std::is_same_v<TVal, Area>)
 		return Variant_Type::Area;
+	else if constexpr(std::is_same_v<TVal, Event_Type>)
+		return Variant_Type::Event_Type;
 	return Variant_Type::Any;
 }
 
@@ -167,6 +173,8 @@ inline Variant_Type GetVariantType(Variant v)
 		return Variant_Type::Line;
 	else if (std::holds_alternative<Area>(v))
 		return Variant_Type::Area;
+	else if (std::holds_alternative<Event_Type>(v))
+		return Variant_Type::Event_Type;
 	return Variant_Type::Any;
 }
 
@@ -210,6 +218,8 @@ inline std::string ToString(Variant_Type v)
 		return "Line";
 	case Variant_Type::Area:
 		return "Area";
+	case Variant_Type::Event_Type:
+		return "Event_Type";
 	case Variant_Type::Any:
 		return "Any";
 	}
@@ -254,6 +264,8 @@ inline Variant_Type FromString(std::string s)
 		return Variant_Type::Line;
 	else if (s == "Area")
 		return Variant_Type::Area;
+	else if (s == "Event_Type")
+		return Variant_Type::Event_Type;
 	else if (s == "Any")
 		return Variant_Type::Any;
 	return Variant_Type::Any;
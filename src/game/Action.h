@@ -22,6 +22,8 @@ enum class Action_Type
 	Reproduce
 };
 
+constexpr int action_type_count = static_cast<int>(Action_Type::Reproduce) + 1;
+
 struct Action_Settings
 {
 	Energy cost {0};
@@ -48,6 +50,19 @@ enum class Action_Result
 };
 
 
+// a unit's pending action checked against the state at the start of the tick
+// see Game::AllUnitsTakeAction
+struct Action_Intent
+{
+	UnitID unit{-1};
+	Action_Type type {Action_Type::Nothing};
+	Point destination; // for Move and Reproduce
+	UnitID target{-1}; // for Attack and Heal
+	Energy magnitude {0};
+	std::optional<Unit_Type> spawn_type; // drawn at random when resolved if empty
+	Action_Result result {Action_Result::Waiting};
+};
+
 struct Action_Magnitude_Modifier
 {
 	Energy amount;
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef BRUSHLINK_ACTION_SCHEDULE_H
+#define BRUSHLINK_ACTION_SCHEDULE_H
+
+#include <vector>
+
+#include "Game_Basic_Types.h"
+#include "Game_Time.h"
+#include "Timing_Wheel.h"
+
+namespace Brushlink
+{
+
+// units that can't act until a known tick are parked in a timing wheel
+// so the action loop only visits units that might act this tick
+struct Action_Schedule
+{
+	Timing_Wheel parked;
+	// units to visit this tick, in the order they were woken or spawned
+	std::vector<UnitID> active;
+
+	inline void Activate(UnitID unit)
+	{
+		active.push_back(unit);
+	}
+
+	inline void Park(UnitID unit, Ticks wake_tick)
+	{
+		parked.Add(unit, wake_tick);
+	}
+
+	// moves every entry due at now into active
+	// the caller checks the unit still exists and is still parked until now
+	template<typename F>
+	void Wake(Ticks now, F && still_parked_until)
+	{
+		parked.TakeDue(now, [&](UnitID unit, Ticks wake_tick)
+		{
+			if (still_parked_until(unit, wake_tick))
+			{
+				active.push_back(unit);
+			}
+		});
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_ACTION_SCHEDULE_H
@@ -0,0 +1,218 @@
+
+#include "Area_Bits.h"
+#include "Circle_Stencil.h"
+
+#include <algorithm>
+#include <bitset>
+
+namespace Brushlink
+{
+
+Area_Bits Area_Bits::Bounds(Point bottom_left, Point top_right)
+{
+	Area_Bits a;
+	a.Reserve(WordColumn(bottom_left.x), bottom_left.y,
+		WordColumn(top_right.x), top_right.y);
+	return a;
+}
+
+Area_Bits Area_Bits::FromArea(const Area & area)
+{
+	Area_Bits a;
+	if (area.points.empty())
+	{
+		return a;
+	}
+	Point min = *area.points.begin();
+	Point max = min;
+	for (auto & point : area.points)
+	{
+		min.x = std::min(min.x, point.x);
+		min.y = std::min(min.y, point.y);
+		max.x = std::max(max.x, point.x);
+		max.y = std::max(max.y, point.y);
+	}
+	a = Bounds(min, max);
+	for (auto & point : area.points)
+	{
+		a.Insert(point);
+	}
+	return a;
+}
+
+Area_Bits Area_Bits::Circle(Point center, float radius)
+{
+	Area_Bits a;
+	Circle_Stencil::Get(radius).StampInto(a, center);
+	return a;
+}
+
+Area Area_Bits::ToArea() const
+{
+	Area a;
+	ForEachPoint([&](Point p)
+	{
+		a.points.insert(p);
+	});
+	return a;
+}
+
+bool Area_Bits::IsEmpty() const
+{
+	for (auto word : words)
+	{
+		if (word != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int Area_Bits::Count() const
+{
+	int count = 0;
+	for (auto word : words)
+	{
+		count += std::bitset<word_bits>{word}.count();
+	}
+	return count;
+}
+
+void Area_Bits::Insert(Point p)
+{
+	int column = WordColumn(p.x);
+	Reserve(column, p.y, column, p.y);
+	words[(p.y - y) * word_width + (column - word_x)] |= Bit(p.x);
+}
+
+void Area_Bits::Erase(Point p)
+{
+	if (!Contains(p))
+	{
+		return;
+	}
+	words[(p.y - y) * word_width + (WordColumn(p.x) - word_x)] &= ~Bit(p.x);
+}
+
+void Area_Bits::InsertSpan(int row_y, int x_min, int x_max)
+{
+	if (x_max < x_min)
+	{
+		return;
+	}
+	int first = WordColumn(x_min);
+	int last = WordColumn(x_max);
+	Reserve(first, row_y, last, row_y);
+	uint64_t * row = &words[(row_y - y) * word_width];
+	first -= word_x;
+	last -= word_x;
+	uint64_t first_mask = ~uint64_t{0} << (x_min & (word_bits - 1));
+	uint64_t last_mask = ~uint64_t{0} >> (word_bits - 1 - (x_max & (word_bits - 1)));
+	if (first == last)
+	{
+		row[first] |= first_mask & last_mask;
+		return;
+	}
+	row[first] |= first_mask;
+	for (int column = first + 1; column < last; column++)
+	{
+		row[column] = ~uint64_t{0};
+	}
+	row[last] |= last_mask;
+}
+
+void Area_Bits::Clear()
+{
+	std::fill(words.begin(), words.end(), 0);
+}
+
+void Area_Bits::UnionWith(const Area_Bits & other)
+{
+	if (other.height == 0 || other.word_width == 0)
+	{
+		return;
+	}
+	Reserve(other.word_x, other.y,
+		other.word_x + other.word_width - 1, other.y + other.height - 1);
+	int column_offset = other.word_x - word_x;
+	for (int row = 0; row < other.height; row++)
+	{
+		uint64_t * dest = &words[(other.y - y + row) * word_width + column_offset];
+		const uint64_t * source = &other.words[row * other.word_width];
+		for (int column = 0; column < other.word_width; column++)
+		{
+			dest[column] |= source[column];
+		}
+	}
+}
+
+void Area_Bits::IntersectWith(const Area_Bits & other)
+{
+	for (int row = 0; row < height; row++)
+	{
+		int other_row = y + row - other.y;
+		for (int column = 0; column < word_width; column++)
+		{
+			int other_column = word_x + column - other.word_x;
+			uint64_t & word = words[row * word_width + column];
+			if (other_row < 0 || other_row >= other.height
+				|| other_column < 0 || other_column >= other.word_width)
+			{
+				word = 0;
+				continue;
+			}
+			word &= other.words[other_row * other.word_width + other_column];
+		}
+	}
+}
+
+void Area_Bits::DifferenceWith(const Area_Bits & other)
+{
+	int row_begin = std::max(y, other.y);
+	int row_end = std::min(y + height, other.y + other.height);
+	int column_begin = std::max(word_x, other.word_x);
+	int column_end = std::min(word_x + word_width, other.word_x + other.word_width);
+	for (int world_row = row_begin; world_row < row_end; world_row++)
+	{
+		uint64_t * dest = &words[(world_row - y) * word_width];
+		const uint64_t * source = &other.words[(world_row - other.y) * other.word_width];
+		for (int column = column_begin; column < column_end; column++)
+		{
+			dest[column - word_x] &= ~source[column - other.word_x];
+		}
+	}
+}
+
+void Area_Bits::Reserve(int word_x_min, int y_min, int word_x_max, int y_max)
+{
+	if (height > 0 && word_width > 0
+		&& word_x_min >= word_x && word_x_max < word_x + word_width
+		&& y_min >= y && y_max < y + height)
+	{
+		return;
+	}
+	if (height > 0 && word_width > 0)
+	{
+		word_x_min = std::min(word_x_min, word_x);
+		word_x_max = std::max(word_x_max, word_x + word_width - 1);
+		y_min = std::min(y_min, y);
+		y_max = std::max(y_max, y + height - 1);
+	}
+	int new_width = word_x_max - word_x_min + 1;
+	int new_height = y_max - y_min + 1;
+	std::vector<uint64_t> grown(static_cast<std::size_t>(new_width) * new_height, 0);
+	for (int row = 0; row < height; row++)
+	{
+		std::copy_n(&words[row * word_width],
+			word_width,
+			&grown[(y + row - y_min) * new_width + (word_x - word_x_min)]);
+	}
+	words = std::move(grown);
+	word_x = word_x_min;
+	y = y_min;
+	word_width = new_width;
+	height = new_height;
+}
+
+} // namespace Brushlink
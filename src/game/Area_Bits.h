@@ -0,0 +1,94 @@
+#pragma once
+#ifndef BRUSHLINK_AREA_BITS_H
+#define BRUSHLINK_AREA_BITS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Location.h"
+
+namespace Brushlink
+{
+
+// dense alternative to Area for large regions that get combined often
+// such as vision and fog. Area is still preferable for small sparse sets
+// rows are stored as 64 bit words aligned to world x / 64
+// so set algebra between two grids is done a word at a time
+struct Area_Bits
+{
+	static constexpr int word_bits = 64;
+
+	int word_x = 0; // first word column, each column covers 64 tiles
+	int y = 0; // first row
+	int word_width = 0;
+	int height = 0;
+	std::vector<uint64_t> words;
+
+	// empty grid already covering the inclusive box
+	static Area_Bits Bounds(Point bottom_left, Point top_right);
+	static Area_Bits FromArea(const Area & area);
+	static Area_Bits Circle(Point center, float radius);
+
+	Area ToArea() const;
+
+	static inline int WordColumn(int x)
+	{
+		// arithmetic shift rounds toward negative infinity
+		return x >> 6;
+	}
+
+	static inline uint64_t Bit(int x)
+	{
+		return uint64_t{1} << (x & (word_bits - 1));
+	}
+
+	inline bool Contains(Point p) const
+	{
+		int column = WordColumn(p.x) - word_x;
+		int row = p.y - y;
+		if (column < 0 || column >= word_width
+			|| row < 0 || row >= height)
+		{
+			return false;
+		}
+		return (words[row * word_width + column] & Bit(p.x)) != 0;
+	}
+
+	bool IsEmpty() const;
+	int Count() const;
+
+	void Insert(Point p);
+	void Erase(Point p);
+	// inclusive on both ends
+	void InsertSpan(int row_y, int x_min, int x_max);
+	void Clear();
+
+	void UnionWith(const Area_Bits & other);
+	void IntersectWith(const Area_Bits & other);
+	void DifferenceWith(const Area_Bits & other);
+
+	// grows the bounds so the inclusive word columns and rows are covered
+	void Reserve(int word_x_min, int y_min, int word_x_max, int y_max);
+
+	template<typename F>
+	void ForEachPoint(F && f) const
+	{
+		for (int row = 0; row < height; row++)
+		{
+			for (int column = 0; column < word_width; column++)
+			{
+				uint64_t word = words[row * word_width + column];
+				while (word != 0)
+				{
+					int bit = __builtin_ctzll(word);
+					f(Point{(word_x + column) * word_bits + bit, y + row});
+					word &= word - 1;
+				}
+			}
+		}
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_AREA_BITS_H
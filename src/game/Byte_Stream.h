@@ -0,0 +1,179 @@
+#pragma once
+#ifndef BRUSHLINK_BYTE_STREAM_H
+#define BRUSHLINK_BYTE_STREAM_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Brushlink
+{
+
+// little endian binary encoding for files
+// varints take 7 bits per byte so small numbers and deltas take a single byte
+// signed values are zigzag encoded first so small negative numbers stay small too
+struct Byte_Writer
+{
+	std::vector<uint8_t> bytes;
+
+	inline void PutByte(uint8_t value)
+	{
+		bytes.push_back(value);
+	}
+
+	inline void PutVarint(uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			bytes.push_back(static_cast<uint8_t>(value) | 0x80);
+			value >>= 7;
+		}
+		bytes.push_back(static_cast<uint8_t>(value));
+	}
+
+	inline void PutSigned(int64_t value)
+	{
+		PutVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+	}
+
+	inline void PutFixed32(uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	inline void PutFixed64(uint64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	inline void PutFloat(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		PutFixed32(bits);
+	}
+
+	inline void PutBytes(const uint8_t * data, std::size_t size)
+	{
+		PutVarint(size);
+		bytes.insert(bytes.end(), data, data + size);
+	}
+
+	inline void PutString(const std::string & value)
+	{
+		PutBytes(reinterpret_cast<const uint8_t *>(value.data()), value.size());
+	}
+};
+
+// reads what Byte_Writer wrote, from memory it doesn't own
+// reading past the end returns zeros and sets failed instead of throwing
+// so a whole record can be read and then checked once
+struct Byte_Reader
+{
+	const uint8_t * data = nullptr;
+	std::size_t size = 0;
+	std::size_t offset = 0;
+	bool failed = false;
+
+	inline bool AtEnd() const
+	{
+		return offset >= size;
+	}
+
+	inline uint8_t GetByte()
+	{
+		if (offset >= size)
+		{
+			failed = true;
+			return 0;
+		}
+		return data[offset++];
+	}
+
+	inline uint64_t GetVarint()
+	{
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			uint8_t byte = GetByte();
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return value;
+			}
+		}
+		failed = true;
+		return value;
+	}
+
+	inline int64_t GetSigned()
+	{
+		uint64_t value = GetVarint();
+		return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+	}
+
+	inline uint32_t GetFixed32()
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			value |= static_cast<uint32_t>(GetByte()) << (i * 8);
+		}
+		return value;
+	}
+
+	inline uint64_t GetFixed64()
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < 8; i++)
+		{
+			value |= static_cast<uint64_t>(GetByte()) << (i * 8);
+		}
+		return value;
+	}
+
+	inline float GetFloat()
+	{
+		uint32_t bits = GetFixed32();
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// points into data, valid as long as it is
+	inline const uint8_t * GetBytes(std::size_t & length)
+	{
+		length = GetVarint();
+		if (failed || length > size - offset)
+		{
+			failed = true;
+			length = 0;
+			return nullptr;
+		}
+		const uint8_t * start = data + offset;
+		offset += length;
+		return start;
+	}
+
+	inline std::string GetString()
+	{
+		std::size_t length = 0;
+		const uint8_t * start = GetBytes(length);
+		if (start == nullptr)
+		{
+			return {};
+		}
+		return std::string{reinterpret_cast<const char *>(start), length};
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_BYTE_STREAM_H
@@ -0,0 +1,117 @@
+
+#include "Chunk_Map.h"
+
+#include <algorithm>
+
+namespace Brushlink
+{
+
+Chunk_Map::Chunk_Map(int width, int height)
+	: width(width)
+	, height(height)
+	, chunks_wide((width + World_Chunk::size - 1) / World_Chunk::size)
+	, chunks_high((height + World_Chunk::size - 1) / World_Chunk::size)
+{
+	chunks.resize(static_cast<std::size_t>(chunks_wide) * chunks_high);
+}
+
+World_Chunk & Chunk_Map::GetChunk(Point p)
+{
+	std::shared_ptr<World_Chunk> & chunk = chunks[ChunkIndex(p)];
+	if (chunk && chunk->owner != owner)
+	{
+		std::shared_ptr<World_Chunk> copy{new World_Chunk{}};
+		copy->origin = chunk->origin;
+		copy->owner = owner;
+		std::copy_n(chunk->occupancy, World_Chunk::tile_count, copy->occupancy);
+		std::copy_n(chunk->terrain, World_Chunk::tile_count, copy->terrain);
+		std::copy_n(chunk->neighbor_count, World_Chunk::tile_count, copy->neighbor_count);
+		chunk = std::move(copy);
+	}
+	return GetChunkForDrawing(p);
+}
+
+World_Chunk & Chunk_Map::GetChunkForDrawing(Point p)
+{
+	std::shared_ptr<World_Chunk> & chunk = chunks[ChunkIndex(p)];
+	if (chunk)
+	{
+		return *chunk;
+	}
+	chunk.reset(new World_Chunk{});
+	chunk->owner = owner;
+	chunk->origin = {
+		p.x & ~(World_Chunk::size - 1),
+		p.y & ~(World_Chunk::size - 1)
+	};
+	std::fill_n(chunk->occupancy, World_Chunk::tile_count, no_unit);
+	std::fill_n(chunk->neighbor_count, World_Chunk::tile_count, 0);
+	for (int y = 0; y < World_Chunk::size; y++)
+	{
+		for (int x = 0; x < World_Chunk::size; x++)
+		{
+			Point tile = chunk->origin + Point{x, y};
+			chunk->terrain[World_Chunk::TileIndex(tile)] = GenerateTerrain(tile);
+		}
+	}
+	return *chunk;
+}
+
+bool Chunk_Map::SetOccupant(Point p, UnitID id)
+{
+	if (!InBounds(p))
+	{
+		return false;
+	}
+	UnitID & occupant = GetChunk(p).occupancy[World_Chunk::TileIndex(p)];
+	bool was_empty = occupant == no_unit;
+	bool is_empty = id == no_unit;
+	occupant = id;
+	if (was_empty && !is_empty)
+	{
+		AddToNeighborCounts(p, 1);
+		if (GetNeighborCount(p) >= crowded_threshold)
+		{
+			newly_crowded.push_back(p);
+		}
+	}
+	else if (!was_empty && is_empty)
+	{
+		AddToNeighborCounts(p, -1);
+	}
+	return true;
+}
+
+void Chunk_Map::AddToNeighborCounts(Point center, int delta)
+{
+	for (int y = center.y - 1; y <= center.y + 1; y++)
+	{
+		for (int x = center.x - 1; x <= center.x + 1; x++)
+		{
+			Point p{x, y};
+			if (p == center || !InBounds(p))
+			{
+				continue;
+			}
+			World_Chunk & chunk = GetChunk(p);
+			int index = World_Chunk::TileIndex(p);
+			chunk.neighbor_count[index] += delta;
+			if (delta > 0
+				&& chunk.neighbor_count[index] == crowded_threshold
+				&& chunk.occupancy[index] != no_unit)
+			{
+				newly_crowded.push_back(p);
+			}
+		}
+	}
+}
+
+uint8_t Chunk_Map::GenerateTerrain(Point p)
+{
+	// 3x3 checkers
+	bool x_modularity = p.x % 6 / 3;
+	bool y_modularity = p.y % 6 / 3;
+	return x_modularity == y_modularity ? 0 : 1;
+}
+
+} // namespace Brushlink
@@ -0,0 +1,136 @@
+#pragma once
+#ifndef BRUSHLINK_CHUNK_MAP_H
+#define BRUSHLINK_CHUNK_MAP_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tigr.h"
+
+#include "Game_Basic_Types.h"
+#include "Location.h"
+#include "Cow_Owner.h"
+
+namespace Brushlink
+{
+
+// fixed size square of tiles, only allocated once something touches it
+struct World_Chunk
+{
+	static constexpr int size_bits = 5;
+	static constexpr int size = 1 << size_bits;
+	static constexpr int tile_count = size * size;
+
+	Point origin; // bottom left tile
+	uint32_t owner = 0; // see Cow_Owner.h
+	UnitID occupancy[tile_count];
+	uint8_t terrain[tile_count]; // index into World_Settings::checker_colors
+	// occupied tiles among the 8 surrounding each tile
+	uint8_t neighbor_count[tile_count];
+	// rasterized on demand by the renderer and dropped when off screen for a while
+	// not part of the game state, so not copied when a shared chunk is written to
+	std::shared_ptr<Tigr> drawn_terrain;
+	int last_drawn_frame = 0;
+
+	static inline int TileIndex(Point p)
+	{
+		return ((p.y & (size - 1)) << size_bits) | (p.x & (size - 1));
+	}
+};
+
+// the world split into lazily allocated chunks
+// so memory scales with the part of the map that is in use
+// chunks are copy on write, see Cow_Owner.h
+struct Chunk_Map
+{
+	int width = 0; // in tiles
+	int height = 0;
+	int chunks_wide = 0;
+	int chunks_high = 0;
+	std::vector<std::shared_ptr<World_Chunk>> chunks; // nullptr until allocated
+	uint32_t owner = 0;
+	// occupied tiles that reached this many neighbors since the last time
+	// newly_crowded was cleared, so crowding doesn't need to check every unit
+	int crowded_threshold = 9;
+	std::vector<Point> newly_crowded;
+
+	Chunk_Map() = default;
+
+	Chunk_Map(int width, int height);
+
+	inline bool InBounds(Point p) const
+	{
+		return static_cast<unsigned>(p.x) < static_cast<unsigned>(width)
+			&& static_cast<unsigned>(p.y) < static_cast<unsigned>(height);
+	}
+
+	inline int ChunkIndex(Point p) const
+	{
+		return (p.y >> World_Chunk::size_bits) * chunks_wide
+			+ (p.x >> World_Chunk::size_bits);
+	}
+
+	// nullptr if the tile is out of bounds or its chunk was never allocated
+	inline const World_Chunk * FindChunk(Point p) const
+	{
+		if (!InBounds(p))
+		{
+			return nullptr;
+		}
+		return chunks[ChunkIndex(p)].get();
+	}
+
+	inline void Fork()
+	{
+		owner = NewCowOwner();
+	}
+
+	// allocates the chunk if needed and copies it if it's from before a Fork, p must be in bounds
+	World_Chunk & GetChunk(Point p);
+	// allocates the chunk if needed but doesn't copy it
+	// for the renderer, which only writes drawn_terrain and last_drawn_frame
+	World_Chunk & GetChunkForDrawing(Point p);
+
+	inline UnitID GetOccupant(Point p) const
+	{
+		const World_Chunk * chunk = FindChunk(p);
+		if (chunk == nullptr)
+		{
+			return no_unit;
+		}
+		return chunk->occupancy[World_Chunk::TileIndex(p)];
+	}
+
+	// also keeps neighbor counts in sync when a tile becomes empty or full
+	bool SetOccupant(Point p, UnitID id);
+
+	inline int GetNeighborCount(Point p) const
+	{
+		const World_Chunk * chunk = FindChunk(p);
+		if (chunk == nullptr)
+		{
+			return 0;
+		}
+		return chunk->neighbor_count[World_Chunk::TileIndex(p)];
+	}
+
+	void AddToNeighborCounts(Point center, int delta);
+
+	// terrain is procedural, so unallocated chunks don't need to be created to read it
+	static uint8_t GenerateTerrain(Point p);
+
+	inline uint8_t GetTerrain(Point p) const
+	{
+		const World_Chunk * chunk = FindChunk(p);
+		if (chunk == nullptr)
+		{
+			return GenerateTerrain(p);
+		}
+		return chunk->terrain[World_Chunk::TileIndex(p)];
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_CHUNK_MAP_H
@@ -0,0 +1,76 @@
+
+#include "Circle_Stencil.h"
+
+#include <mutex>
+
+namespace Brushlink
+{
+
+const Circle_Stencil & Circle_Stencil::Get(float radius)
+{
+	// each thread remembers the stencils it has already looked up
+	// so only the first use of a radius on a thread takes the lock
+	// vision and the spatial index call this for every move, some from worker threads
+	thread_local Map<float, const Circle_Stencil *> local_cache;
+	auto local = local_cache.find(radius);
+	if (local != local_cache.end())
+	{
+		return *local->second;
+	}
+
+	// the node based map keeps references stable as new radii are added
+	static Map<float, Circle_Stencil> cache;
+	static std::mutex cache_mutex;
+	std::lock_guard<std::mutex> lock{cache_mutex};
+	auto found = cache.find(radius);
+	if (found == cache.end())
+	{
+		found = cache.emplace(radius, Compute(radius)).first;
+	}
+	local_cache.emplace(radius, &found->second);
+	return found->second;
+}
+
+Circle_Stencil Circle_Stencil::Compute(float radius)
+{
+	Circle_Stencil stencil;
+	stencil.radius = radius;
+	stencil.bounds = static_cast<int>(radius + 1.0);
+	float radius_squared = radius * radius;
+	for (int y = -stencil.bounds; y <= stencil.bounds; y++)
+	{
+		int half_width = stencil.bounds;
+		while (half_width >= 0
+			&& static_cast<float>(half_width * half_width + y * y) > radius_squared)
+		{
+			half_width--;
+		}
+		stencil.half_widths.push_back(half_width);
+		for (int x = -half_width; x <= half_width; x++)
+		{
+			stencil.offsets.push_back({x, y});
+		}
+	}
+	return stencil;
+}
+
+void Circle_Stencil::StampInto(Area & area, Point center) const
+{
+	for (auto & offset : offsets)
+	{
+		area.points.insert(center + offset);
+	}
+}
+
+void Circle_Stencil::StampInto(Area_Bits & area, Point center) const
+{
+	area.Reserve(
+		Area_Bits::WordColumn(center.x - bounds), center.y - bounds,
+		Area_Bits::WordColumn(center.x + bounds), center.y + bounds);
+	ForEachSpan(center, [&](int y, int x_min, int x_max)
+	{
+		area.InsertSpan(y, x_min, x_max);
+	});
+}
+
+} // namespace Brushlink
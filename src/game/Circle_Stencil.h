@@ -0,0 +1,66 @@
+#pragma once
+#ifndef BRUSHLINK_CIRCLE_STENCIL_H
+#define BRUSHLINK_CIRCLE_STENCIL_H
+
+#include <vector>
+
+#include "Location.h"
+#include "Area_Bits.h"
+
+namespace Brushlink
+{
+
+// the tiles within radius of the origin, computed once per distinct radius
+// and translated to a center point whenever it is stamped
+struct Circle_Stencil
+{
+	float radius = 0.0;
+	int bounds = 0;
+	// half width of the span for each row offset from -bounds to bounds
+	// negative for rows that the circle doesn't reach
+	std::vector<int> half_widths;
+	// every covered offset, row by row
+	std::vector<Point> offsets;
+
+	// cached, the returned reference stays valid for the whole program
+	static const Circle_Stencil & Get(float radius);
+
+	static Circle_Stencil Compute(float radius);
+
+	inline int HalfWidth(int dy) const
+	{
+		if (dy < -bounds || dy > bounds)
+		{
+			return -1;
+		}
+		return half_widths[dy + bounds];
+	}
+
+	inline bool Contains(Point center, Point p) const
+	{
+		int half_width = HalfWidth(p.y - center.y);
+		return abs(p.x - center.x) <= half_width;
+	}
+
+	void StampInto(Area & area, Point center) const;
+	void StampInto(Area_Bits & area, Point center) const;
+
+	// calls f(y, x_min, x_max) for each covered row, inclusive
+	template<typename F>
+	void ForEachSpan(Point center, F && f) const
+	{
+		for (int dy = -bounds; dy <= bounds; dy++)
+		{
+			int half_width = half_widths[dy + bounds];
+			if (half_width < 0)
+			{
+				continue;
+			}
+			f(center.y + dy, center.x - half_width, center.x + half_width);
+		}
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_CIRCLE_STENCIL_H
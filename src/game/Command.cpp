@@ -1,6 +1,9 @@
 #include "Command.h"
 #include "Context.h"
 #include "Game.h"
+#include "Byte_Stream.h"
+
+#include <algorithm>
 
 using namespace Command;
 
@@ -15,7 +18,7 @@ struct Action_Move : Action_Command
 		: location(location)
 	{ }
 
-	Action_Step Evaluate(Command::Context & context, Unit & unit)
+	Action_Step Evaluate(const Command_View & view, const Unit & unit) const override
 	{
 		Point next = unit.position;
 		int distance = location.CardinalDistance(next);
@@ -33,8 +36,8 @@ struct Action_Move : Action_Command
 				distance = neighbor_distance;
 			}
 			else if (neighbor_distance == distance
-				&& Contains(context.game->world.positions, next)
-				&& !Contains(context.game->world.positions, neighbor))
+				&& view.game.world.IsOccupied(next)
+				&& !view.game.world.IsOccupied(neighbor))
 			{
 				next = neighbor;
 			}
@@ -46,23 +49,81 @@ struct Action_Move : Action_Command
 	{
 		return new Action_Move{*this};
 	}
+
+	const char * SaveName() const override { return "Move"; }
+
+	void Save(Byte_Writer & writer) const override
+	{
+		writer.PutSigned(location.x);
+		writer.PutSigned(location.y);
+	}
+
+	static Action_Command * Load(Byte_Reader & reader)
+	{
+		Point location;
+		location.x = reader.GetSigned();
+		location.y = reader.GetSigned();
+		return new Action_Move{location};
+	}
 };
 
+// function local so commands in other modules can register during static initialization
+static Map<std::string, Action_Command_Loader> & GetActionCommandLoaders()
+{
+	static Map<std::string, Action_Command_Loader> loaders {
+		{"Idle", [](Byte_Reader &) { return new Action_Command{}; }},
+		{"Move", &Action_Move::Load},
+	};
+	return loaders;
+}
+
+bool RegisterActionCommand(const std::string & name, Action_Command_Loader loader)
+{
+	return GetActionCommandLoaders().emplace(name, loader).second;
+}
+
+Action_Command_Loader FindActionCommandLoader(const std::string & name)
+{
+	auto & loaders = GetActionCommandLoaders();
+	auto found = loaders.find(name);
+	if (found == loaders.end())
+	{
+		return nullptr;
+	}
+	return found->second;
+}
+
 void Move(Command::Context & context, Unit_Group actors, Point location)
 {
-	for (auto & unit_id : actors.members)
+	Issued_Command command{context.player->id, Issued_Command_Type::Move, {}, location};
+	command.actors.assign(actors.members.begin(), actors.members.end());
+	std::sort(command.actors.begin(), command.actors.end(), [](UnitID a, UnitID b)
 	{
-		ErrorOr<Ref<Unit>> result = context.GetUnit(unit_id);
-		if (result.IsError())
+		return a.value < b.value;
+	});
+	context.game->Issue(std::move(command));
+}
+
+void Apply(Game & game, const Issued_Command & command)
+{
+	for (auto & unit_id : command.actors)
+	{
+		Unit * unit = game.world.GetUnit(unit_id);
+		if (unit == nullptr || unit->player != command.player)
 		{
 			// rmf todo: log invalid unit id? report back to user?
 			continue;
 		}
-		auto unit = result.GetValue().get();
-		std::queue<value_ptr<Action_Command> > empty;
-		std::swap(unit.command_queue, empty);
-		// rmf todo: get offset from average location
-		unit.command_queue.push({new Action_Move{location}});
+		Unit_Orders & orders = game.world.GetOrders(*unit);
+		decltype(orders.command_queue) empty;
+		std::swap(orders.command_queue, empty);
+		switch (command.type)
+		{
+		case Issued_Command_Type::Move:
+			// rmf todo: get offset from average location
+			orders.command_queue.push({new Action_Move{command.location}});
+			break;
+		}
 	}
 }
 
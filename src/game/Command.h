@@ -2,12 +2,10 @@
 #ifndef BRUSHLINK_COMMAND_H
 #define BRUSHLINK_COMMAND_H
 
-#include "Action.h"
+#include <string>
+#include <vector>
 
-namespace Command
-{
-	struct Context;
-} // namespace Command
+#include "Action.h"
 
 namespace Brushlink
 {
@@ -15,6 +13,9 @@ namespace Brushlink
 // forward declare for Evaluate parameter, maybe not necessary
 struct Unit;
 struct Game;
+struct Player;
+struct Byte_Writer;
+struct Byte_Reader;
 
 // temporary
 /*
@@ -27,11 +28,20 @@ struct Context
 };
 */
 
+// what a command can look at while it's evaluated
+// evaluations run in parallel, so all of it is const, see Game::AllUnitsTakeAction
+struct Command_View
+{
+	const Game & game;
+	const Player & player; // the unit's owner
+};
+
 // temporary
+// evaluated for each unit that needs a new pending action
 struct Action_Command
 {
-	Action_Step Evaluate(Command::Context & context, Unit & unit) { return {}; }
-	bool EvaluateEveryTick() { return false; }
+	virtual Action_Step Evaluate(const Command_View & view, const Unit & unit) const { return {}; }
+	virtual bool EvaluateEveryTick() { return false; }
 
 	virtual ~Action_Command()
 	{ }
@@ -40,9 +50,40 @@ struct Action_Command
 	{
 		return new Action_Command{};
 	}
+
+	// for save files, the name it was registered under, see RegisterActionCommand
+	virtual const char * SaveName() const { return "Idle"; }
+	// only commands with state of their own write anything
+	virtual void Save(Byte_Writer & writer) const { }
 };
 
+// reads what the command's Save wrote
+using Action_Command_Loader = Action_Command * (*)(Byte_Reader & reader);
+
+// commands register a loader under their SaveName so save files can rebuild them
+// commands defined outside the game module register themselves the same way
+bool RegisterActionCommand(const std::string & name, Action_Command_Loader loader);
+// nullptr if nothing was registered under the name
+Action_Command_Loader FindActionCommandLoader(const std::string & name);
+
+enum class Issued_Command_Type
+{
+	Move,
+};
+
+// a command a player gave some of their units
+// everything a player does to the game goes through one of these
+// so they can be applied at a tick boundary and recorded in replays, see Game::Issue
+struct Issued_Command
+{
+	PlayerID player;
+	Issued_Command_Type type;
+	std::vector<UnitID> actors; // sorted
+	Point location;
+};
 
+// replaces the actors' command queues with the command
+void Apply(Game & game, const Issued_Command & command);
 
 } // namespace Brushlink
 
@@ -0,0 +1,24 @@
+#pragma once
+#ifndef BRUSHLINK_COW_OWNER_H
+#define BRUSHLINK_COW_OWNER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace Brushlink
+{
+
+// copy on write storage tags each chunk or page with the id of its owner
+// and copies anything tagged with another id before writing to it
+// forking gives the owner a new id, so everything it held is frozen
+// and it and its copy each write to their own copies from then on
+// nothing frozen is written again, so the two can be advanced on different threads
+inline uint32_t NewCowOwner()
+{
+	static std::atomic<uint32_t> next{1};
+	return next++;
+}
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_COW_OWNER_H
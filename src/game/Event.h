@@ -1,28 +1,226 @@
+#pragma once
+#ifndef BRUSHLINK_EVENT_H
+#define BRUSHLINK_EVENT_H
 
-// an Event system will be a lot of work and doesn't seem worth it at this time
-// reconsider after having other systems working
-// until then just use conditionals every tick
-/*
-struct EventNameTag
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Resources.h"
+#include "Game_Time.h"
+#include "Game_Basic_Types.h"
+#include "Location.h"
+#include "Paged_Array.h"
+
+namespace Brushlink
 {
-	static HString GetName() { return "EventName"; }
-};
-using EventName = NamedType<HString, EventNameTag>;
 
+// things that happened during a tick, so scripts and AI players can react
+// to changes instead of checking every unit every tick
 
-struct EventValueNameTag
+enum class Event_Type
 {
-	static HString GetName() { return "EventValueName"; }
+	Spawn, // actor is the new unit, target the unit that reproduced if any
+	Death,
+	Attack, // actor hit target for amount
+	Heal, // actor healed target for amount
+	Move, // actor moved to position
+	Blocked, // actor couldn't move to position this tick
+	Command_Finished // actor's queued command returned Idle
 };
-using EventValueName = NamedType<HString, EventValueNameTag>;
 
-struct Event
+constexpr int event_type_count = static_cast<int>(Event_Type::Command_Finished) + 1;
+
+// plain data so the ring can be filled without allocating
+struct Game_Event
 {
-	EventName name;
+	Event_Type type;
+	Ticks tick;
 	UnitID actor;
-	std::pair<Unit, Unit> actor_before_after;
-	std::optional<UnitID> target;
-	std::optional<std::pair<Unit, Unit>> target_before_after;
-	Map<EventValueName, Value> values;
+	PlayerID player; // owner of actor
+	UnitID target {no_unit};
+	Point position;
+	Energy amount {0};
 };
-*/
+
+struct Event_Filter
+{
+	uint32_t types = ~uint32_t{0}; // bit per Event_Type
+	UnitID unit {no_unit}; // actor or target, any unit if no_unit
+	PlayerID player {-1}; // owner of the actor, any player if -1
+
+	static inline uint32_t Bit(Event_Type type)
+	{
+		return uint32_t{1} << static_cast<int>(type);
+	}
+
+	static inline Event_Filter Only(Event_Type type)
+	{
+		Event_Filter filter;
+		filter.types = Bit(type);
+		return filter;
+	}
+
+	inline bool Accepts(const Game_Event & event) const
+	{
+		return (types & Bit(event.type)) != 0
+			&& (unit == no_unit || event.actor == unit || event.target == unit)
+			&& (player.value == -1 || event.player == player);
+	}
+};
+
+// a subscriber's position in the stream, owned by the subscriber
+struct Event_Cursor
+{
+	Event_Filter filter;
+	uint64_t next = 0;
+	uint64_t missed = 0; // overwritten before this cursor read them
+};
+
+// ring of the most recent events, a full ring overwrites the oldest events
+// writing never allocates, the ring only grows between ticks in BeginTick
+// so it holds the previous tick whole while the next is written
+// paged so a snapshot shares it, see Cow_Owner.h
+struct Event_Stream
+{
+	static constexpr int initial_capacity_bits = 14;
+	// how many ticks back TickBegin can find
+	static constexpr int tick_history = 64;
+
+	Paged_Array<Game_Event> events; // size is a power of two
+	uint64_t written = 0;
+	// events before this were overwritten before the ring last grew
+	uint64_t overwritten = 0;
+	// index of the first event of each recent tick, by tick % tick_history
+	std::vector<uint64_t> tick_starts;
+	std::vector<int> tick_numbers;
+
+	Event_Stream()
+		: tick_starts(tick_history, 0)
+		, tick_numbers(tick_history, -1)
+	{
+		for (int i = 0; i < (1 << initial_capacity_bits); i++)
+		{
+			events.Append({});
+		}
+	}
+
+	inline uint64_t Mask() const
+	{
+		return events.size - 1;
+	}
+
+	inline void Fork()
+	{
+		events.Fork();
+	}
+
+	inline void BeginTick(Ticks tick)
+	{
+		// room for twice the last tick, so a tick of the same size
+		// can be written without overwriting any of the last one
+		int last_slot = (tick.value + tick_history - 1) % tick_history;
+		if (tick_numbers[last_slot] == tick.value - 1)
+		{
+			uint64_t last_count = written - tick_starts[last_slot];
+			if (last_count * 2 > static_cast<uint64_t>(events.size))
+			{
+				Grow(last_count * 2);
+			}
+		}
+		tick_starts[tick.value % tick_history] = written;
+		tick_numbers[tick.value % tick_history] = tick.value;
+	}
+
+	// keeps every event still in the ring at the same index
+	inline void Grow(uint64_t min_capacity)
+	{
+		uint64_t capacity = events.size;
+		while (capacity < min_capacity)
+		{
+			capacity *= 2;
+		}
+		Paged_Array<Game_Event> grown;
+		grown.owner = events.owner;
+		for (uint64_t i = 0; i < capacity; i++)
+		{
+			grown.Append({});
+		}
+		overwritten = Oldest();
+		for (uint64_t i = overwritten; i < written; i++)
+		{
+			grown[i & (capacity - 1)] = std::as_const(events)[i & Mask()];
+		}
+		events = std::move(grown);
+	}
+
+	inline void Push(const Game_Event & event)
+	{
+		events[written & Mask()] = event;
+		written++;
+	}
+
+	inline uint64_t Oldest() const
+	{
+		uint64_t capacity = events.size;
+		return std::max(overwritten, written > capacity ? written - capacity : 0);
+	}
+
+	// a cursor that starts reading at the next event written
+	inline Event_Cursor Subscribe(Event_Filter filter) const
+	{
+		return Event_Cursor{filter, written, 0};
+	}
+
+	// calls f for every event since the cursor's last read that passes its filter
+	template<typename F>
+	void Read(Event_Cursor & cursor, F && f) const
+	{
+		if (cursor.next < Oldest())
+		{
+			cursor.missed += Oldest() - cursor.next;
+			cursor.next = Oldest();
+		}
+		for (; cursor.next < written; cursor.next++)
+		{
+			const Game_Event & event = events[cursor.next & Mask()];
+			if (cursor.filter.Accepts(event))
+			{
+				f(event);
+			}
+		}
+	}
+
+	// every event of one recent tick that passes the filter
+	// false if some of its events were overwritten, f has only seen the rest
+	// a tick that wasn't recorded or is too old reads as having no events
+	template<typename F>
+	bool ReadTick(Ticks tick, const Event_Filter & filter, F && f) const
+	{
+		int slot = tick.value % tick_history;
+		if (tick.value < 0 || tick_numbers[slot] != tick.value)
+		{
+			return true;
+		}
+		uint64_t end = written;
+		int next_slot = (tick.value + 1) % tick_history;
+		if (tick_numbers[next_slot] == tick.value + 1)
+		{
+			end = tick_starts[next_slot];
+		}
+		for (uint64_t i = std::max(tick_starts[slot], Oldest()); i < end; i++)
+		{
+			const Game_Event & event = events[i & Mask()];
+			if (filter.Accepts(event))
+			{
+				f(event);
+			}
+		}
+		return tick_starts[slot] >= Oldest();
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_EVENT_H
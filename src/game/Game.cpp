@@ -1,10 +1,10 @@
 
 #include "Game.h"
 
-#include <bitset>
+#include <algorithm>
+#include <array>
 #include <cstdio>
-
-#include "tigr.h"
+#include <utility>
 
 #include "IntExtensions.hpp"
 
@@ -24,7 +24,6 @@ const GameSettings GameSettings::default_settings {
 		{ Unit_Type::Spawner, {
 			Unit_Type::Spawner,
 			{6}, {24}, {{1}, {0.5}}, // more energy in order to reduce healing and make harder to kill
-			{}, // todo: drawn_body	
 			{
 				{ Action_Type::Nothing, Action_Settings{} },
 				{ Action_Type::Idle, Action_Settings{} },
@@ -37,7 +36,6 @@ const GameSettings GameSettings::default_settings {
 		{ Unit_Type::Healer, {
 			Unit_Type::Healer,
 			{8}, {12}, {{1}, {1.0}}, // starts at moderate health, mild regen
-			{}, // todo: drawn_body
 			{
 				{ Action_Type::Nothing, Action_Settings{} },
 				{ Action_Type::Idle, Action_Settings{} },
@@ -54,7 +52,6 @@ const GameSettings GameSettings::default_settings {
 		{ Unit_Type::Attacker, {
 			Unit_Type::Attacker,
 			{12}, {12}, {{1}, {6.0}}, // starts at full health, very slow regen
-			{}, // todo: drawn_body
 			{
 				{ Action_Type::Nothing, Action_Settings{} },
 				{ Action_Type::Idle, Action_Settings{} },
@@ -87,37 +84,24 @@ const GameSettings GameSettings::default_settings {
 
 void Game::Initialize()
 {
+	// before anything can return, Tick and the renderer rely on rules being set
+	if (!rules)
+	{
+		rules = Ruleset::Compile(settings);
+	}
+	world.chunks.crowded_threshold = rules->crowded_threshold.value;
 	if (world.settings.starting_locations.size() < settings.player_settings.size())
 	{
 		Error("Not enough starting locations").Log();
 		// early quit, prevent starting the game, etc?
 		return;
 	}
-	std::shared_ptr<Tigr> palettes_image{
-		tigrLoadImage(settings.palettes_image_file.c_str()),
-		TigrDeleter{}};
 	for (auto & player_pair : settings.player_settings)
 	{
 		PlayerID id = player_pair.first;
 		players[id] = Player::FromSettings(player_pair.second, id, world.settings.starting_locations[id.value]);
-		for (auto & graphics : players[id].data->graphical_preferences)
-		{
-			if (graphics.palette.type == Palette_Type::SingleColor
-				|| graphics.palette.type == Palette_Type::Custom)
-			{
-				continue;
-			}
-			for (int i = 0; i < palettes_image->w; i++)
-			{
-				graphics.palette.colors[i] = tigrGet(
-					palettes_image.get(),
-					i,
-					static_cast<int>(graphics.palette.type)
-				);
-				printf("%08x\n", Pack(graphics.palette.colors[i]));
-				//std::cout << std::bitset<32>{Pack(graphics.palette.colors[i])} << std::endl;
-			}
-		}
+		players[id].root_command_context.game = this;
+		players[id].root_command_context.player = &players[id];
 		players[id].graphics = players[id].data->graphical_preferences.front();
 		if (players[id].settings.type == Player_Type::Local_Player
 			|| local_player.value == -1)
@@ -125,12 +109,24 @@ void Game::Initialize()
 			local_player = id;
 		}
 	}
-	world.energy_bars.reset(tigrLoadImage(settings.energy_image_file.c_str()));
+	// settings are hash maps, so spawn in a fixed order to keep unit ids
+	// and the state hash the same from one run to the next, see Replay
+	std::vector<PlayerID> player_order;
 	for (auto & [player_id, player] : players)
 	{
+		player_order.push_back(player_id);
+	}
+	std::sort(player_order.begin(), player_order.end(), [](PlayerID a, PlayerID b)
+	{
+		return a.value < b.value;
+	});
+	auto starting_units = SortedStartingUnits();
+	for (PlayerID player_id : player_order)
+	{
+		Player & player = players[player_id];
 		world.player_graphics[player_id] = player.graphics;
 
-		for (auto & [offset, unit_type] : settings.starting_units)
+		for (auto & [offset, unit_type] : starting_units)
 		{
 			auto result = SpawnUnit(
 				player_id,
@@ -143,258 +139,308 @@ void Game::Initialize()
 			}
 		}
 	}
-	std::shared_ptr<Tigr> units_image{tigrLoadImage(settings.units_image_file.c_str()), TigrDeleter{}};
-	int px = world.settings.tile_px;
-	int color_count = settings.palette_replace_colors.size();
-	std::vector<uint> packed_colors;
-	for(auto & color : settings.palette_replace_colors)
+}
+
+std::vector<std::pair<Point, Unit_Type> > Game::SortedStartingUnits() const
+{
+	std::vector<std::pair<Point, Unit_Type> > sorted(
+		settings.starting_units.begin(),
+		settings.starting_units.end());
+	std::sort(sorted.begin(), sorted.end(), [](auto & a, auto & b)
+	{
+		return a.first.y != b.first.y
+			? a.first.y < b.first.y
+			: a.first.x < b.first.x;
+	});
+	return sorted;
+}
+
+std::unique_ptr<Game> Game::Snapshot()
+{
+	std::unique_ptr<Game> snapshot{new Game{rules, settings}};
+	world.Fork();
+	snapshot->world = world;
+	snapshot->world.Fork();
+	snapshot->players = players;
+	for (auto & pair : snapshot->players)
 	{
-		packed_colors.push_back(Pack(color));
+		pair.second.root_command_context.game = snapshot.get();
+		pair.second.root_command_context.player = &pair.second;
 	}
-	for (auto & [unit_type, unit_settings] : settings.unit_types)
+	snapshot->local_player = local_player;
+	snapshot->random = random;
+	snapshot->tick = tick;
+	snapshot->schedule = schedule;
+	snapshot->recharges = recharges;
+	snapshot->crowding = crowding;
+	snapshot->dying = dying;
+	snapshot->issued = issued;
+	events.Fork();
+	snapshot->events = events;
+	snapshot->events.Fork();
+	// runs on a thread of its own, next to the live game's workers
+	snapshot->workers.SetThreadCount(0);
+	return snapshot;
+}
+
+void Game::RecordReplay(int keyframe_interval)
+{
+	replay_recorder.reset(new Replay_Recorder{});
+	replay_recorder->keyframe_interval = keyframe_interval;
+	Replay & replay = replay_recorder->replay;
+	replay.seed = random.seed;
+	replay.rules = *rules;
+	replay.width = world.settings.width;
+	replay.height = world.settings.height;
+	replay.starting_locations = world.settings.starting_locations;
+	replay.starting_units = SortedStartingUnits();
+	for (auto & [id, player] : players)
 	{
-		for (auto & [player_id, graphics] : world.player_graphics)
-		{
-			if (graphics.palette.color_count < color_count)
-			{
-				Error("Player Palette doesn't have enough colors").Log();
-				continue;
-			}
-			std::shared_ptr<Tigr> body {tigrBitmap(px, px), TigrDeleter{}};
-			tigrBlit(body.get(),
-				units_image.get(),
-				0, 0, // dest x,y
-				px * static_cast<int>(unit_type),
-				px * static_cast<int>(graphics.pattern),
-				px, px // size
-			);
-			for (int x = 0; x < px; x++)
-			{
-				for (int y = 0; y < px; y++)
-				{
-					uint packed_color = Pack(body->pix[y*px+x]);
-					for (int color_index = 0; color_index < color_count; color_index++)
-					{
-						if (packed_color == packed_colors[color_index])
-						{
-							body->pix[y*px+x] = graphics.palette.colors[color_index];
-						}
-					}
-				}
-			}
-			unit_settings.drawn_body.insert_or_assign(graphics, body);
-		}
+		replay.players.emplace_back(id, player.settings.type);
 	}
+	std::sort(replay.players.begin(), replay.players.end(), [](auto & a, auto & b)
+	{
+		return a.first.value < b.first.value;
+	});
 }
 
-Input_Result Game::ReceiveInput(
-	const Key_Changes &,
-	const Modifiers_State &,
-	const Mouse_State &,
-	const std::vector<Point> &)
+void Game::Issue(Issued_Command command)
 {
-	return Input_Result::NoUpdateNeeded;
+	issued.push_back(std::move(command));
 }
 
 void Game::Tick()
 {
+	Scoped_Timer timer{profiler, Profile_Phase::Tick};
 	// should this be before or after update functions?
 	tick.value += 1;
+	events.BeginTick(tick);
 	ProcessPlayerInput();
 	RunPlayerCoroutines();
 	AllUnitsTakeAction();
 	EnergyTick();
+	RemoveDeadUnits();
+	RecordStateHash();
 }
 
 void Game::ProcessPlayerInput()
 {
+	Scoped_Timer timer{profiler, Profile_Phase::ProcessPlayerInput};
+	for (auto & command : issued)
+	{
+		Apply(*this, command);
+		if (replay_recorder)
+		{
+			replay_recorder->Record(tick, command);
+		}
+	}
+	issued.clear();
 
 }
 
 void Game::RunPlayerCoroutines()
 {
+	Scoped_Timer timer{profiler, Profile_Phase::RunPlayerCoroutines};
 
 }
 
 void Game::AllUnitsTakeAction()
 {
-	// this behavior is currently dependent on the order of operations
-	// we should consider storing pre-step, transition, and post-step states
-	// such as units leaving/entering spaces, spending energy / getting healed
-	// how to reconcile these deterministically?
-	// could construct dependency graphs. some cycles might be okay, such as units swapping positions.
-	// being attacked and therefore not having enough energy to take an action
-	// vs taking the action and then dying. which is preferable? per-unit player setting?
-
-	// if we're adding units with reproducing, then maybe world.units will change
-	// so we should consider not storing these Unit * and just call get every time
-	// but apparently std::map and std::unordered_map both have stable memory
-	Map<Action_Type, std::vector<Unit *>> units_to_act {
-		{Action_Type::Attack, {}},
-		{Action_Type::Heal, {}},
-		{Action_Type::Reproduce, {}},
-		{Action_Type::Move, {}},
-	};
-	std::vector<std::vector<Action_Type>> grouped_action_order {
-		{
-			Action_Type::Heal,
-		},
-		{
-			Action_Type::Reproduce,
-		},
-		{
-			Action_Type::Attack,
-		},
+	Scoped_Timer timer{profiler, Profile_Phase::AllUnitsTakeAction};
+	// actions are taken in two phases so the outcome doesn't depend on
+	// the order units are visited in
+	// 1. every acting unit picks an intent against the state at the start of the tick,
+	//    nothing in the world changes during this phase
+	// 2. ResolveIntents applies all of them together in a single pass
+	// a unit that is attacked this tick still takes its action
+	// even if the attack leaves it without enough energy, it dies in EnergyTick
+
+	// a recompute re-evaluates the unit's command against the same state
+	// so more than a couple of passes can't find anything new
+	const int max_intent_passes = 3;
+
+	auto ParkUntil = [&](Unit & unit, Ticks ready)
+	{
+		// waiting on energy or a recompute stays active
+		if (ready > tick)
 		{
-			Action_Type::Move,
+			unit.wake_tick = ready;
+			schedule.Park(unit.id, ready);
 		}
 	};
-	Set<UnitID> units_remaining{};
 
-	auto AddUnitToAct = [&](Unit & unit)
+	auto UpdateUnitAction = [&](Unit & unit)
 	{
-		if (units_to_act.count(unit.pending.type) > 0)
-		{
-			units_to_act[unit.pending.type].push_back(&unit);
-			units_remaining.insert(unit.id);
-		}
-		else
-		{
-			units_remaining.erase(unit.id);
+		Unit_Orders & orders = world.GetOrders(unit);
+		Action_Command * command = orders.command_queue.empty()
+				? orders.idle_command.get()
+				: orders.command_queue.front().get();
+		world.SetPending(unit, command->Evaluate(
+			Command_View{*this, players.at(unit.player)},
+			unit));
+		if (unit.pending.type == Action_Type::Idle && !orders.command_queue.empty())
+		{
+			orders.command_queue.pop();
+			events.Push({Event_Type::Command_Finished, tick, unit.id, unit.player});
 		}
 	};
 
-	auto UpdateUnitAction = [&](Unit & unit)
+	// parked units are waiting on a known tick and would only return Waiting
+	schedule.Wake(tick, [&](UnitID id, Ticks wake_tick)
+	{
+		Unit * unit = world.GetUnit(id);
+		return unit != nullptr && unit->wake_tick == wake_tick;
+	});
+	std::vector<UnitID> acting;
+	std::swap(acting, schedule.active);
+	// id order keeps the merge of command results deterministic
+	std::sort(acting.begin(), acting.end(), [](UnitID a, UnitID b)
 	{
-		Action_Command * command = unit.command_queue.empty()
-				? unit.idle_command.get()
-				: unit.command_queue.front().get();
-		unit.pending = command->Evaluate(
-			players[unit.player].root_command_context,
-			unit);
-		if (unit.pending.type == Action_Type::Idle && !unit.command_queue.empty())
+		return a.value < b.value;
+	});
+
+	// evaluating commands only reads the world, so every unit that needs a new
+	// pending action is evaluated in parallel and the results are assigned
+	// afterwards in id order
+	// pages shared with a snapshot are only copied by writes, so anything
+	// written here is fetched in this serial pass and the parallel pass
+	// only reads the world through const access
+	std::vector<Unit *> acting_units;
+	std::vector<Unit *> evaluating;
+	std::vector<const Action_Command *> commands;
+	acting_units.reserve(acting.size());
+	for (UnitID id : acting)
+	{
+		Unit * unit = world.GetUnit(id);
+		if (unit == nullptr)
 		{
-			unit.command_queue.pop();
+			// died since it was scheduled
+			continue;
 		}
-	};
+		acting_units.push_back(unit);
+		const Unit_Orders & orders = std::as_const(world).GetOrders(*unit);
+		if (unit->pending.type == Action_Type::Idle
+			|| (unit->pending.type == Action_Type::Nothing
+				&& !orders.command_queue.empty()
+				// is EvaluateEveryTick for coroutines the same as just updating idle action?
+				&& orders.command_queue.front()->EvaluateEveryTick()))
+		{
+			// evaluating is const, so the orders aren't copied out of a shared page
+			evaluating.push_back(unit);
+			commands.push_back(orders.command_queue.empty()
+				? orders.idle_command.get()
+				: orders.command_queue.front().get());
+		}
+	}
+
+	std::vector<Action_Step> evaluated(evaluating.size());
+	{
+		Scoped_Timer evaluate_timer{profiler, Profile_Phase::EvaluateCommands};
+		const int evaluation_batch = 32;
+		workers.ParallelFor(evaluating.size(), evaluation_batch, [&](int i)
+		{
+			const Unit & unit = *evaluating[i];
+			evaluated[i] = commands[i]->Evaluate(
+				Command_View{*this, players.at(unit.player)},
+				unit);
+		});
+	}
 
-	for (auto & pair :  world.units)
+	for (int i = 0; i < static_cast<int>(evaluating.size()); i++)
 	{
-		Unit & unit = pair.second;
-		if (unit.pending.type == Action_Type::Idle)
+		Unit & unit = *evaluating[i];
+		Unit_Orders & orders = world.GetOrders(unit);
+		world.SetPending(unit, evaluated[i]);
+		if (unit.pending.type == Action_Type::Idle && !orders.command_queue.empty())
 		{
-			UpdateUnitAction(unit);
+			orders.command_queue.pop();
+			events.Push({Event_Type::Command_Finished, tick, unit.id, unit.player});
 		}
-		else if (unit.pending.type == Action_Type::Nothing
-			&& !unit.command_queue.empty()
-			// is EvaluateEveryTick for coroutines the same as just updating idle action?
-			&& unit.command_queue.front()->EvaluateEveryTick())
+	}
+
+	std::vector<Action_Intent> intents;
+	intents.reserve(acting_units.size());
+
+	for (Unit * p_unit : acting_units)
+	{
+		Unit & unit = *p_unit;
+		for (int pass = 0; pass < max_intent_passes; pass++)
 		{
-			UpdateUnitAction(unit);
+			Action_Intent intent;
+			Action_Result result = GatherIntent(unit, intent);
+			if (result == Action_Result::Recompute)
+			{
+				UpdateUnitAction(unit);
+				continue;
+			}
+			if (result == Action_Result::Waiting)
+			{
+				ParkUntil(unit, ActionReadyTick(unit));
+			}
+			else if (intent.type == Action_Type::Nothing
+				|| intent.type == Action_Type::Idle)
+			{
+				world.SetPending(unit, Action_Step{Action_Type::Idle, {}, {}});
+			}
+			else
+			{
+				intents.push_back(intent);
+			}
+			break;
 		}
-
-		AddUnitToAct(unit);
 	}
 
-	int unit_count_at_last_loop = units_remaining.size() + 1;
+	ResolveIntents(intents);
 
-	for (auto & action_group : grouped_action_order)
+	for (auto & intent : intents)
 	{
-		while (units_remaining.size() > 0
-			&& units_remaining.size() < unit_count_at_last_loop)
+		Unit * unit = world.GetUnit(intent.unit);
+		if (unit != nullptr
+			&& intent.result == Action_Result::Success)
 		{
-			unit_count_at_last_loop = units_remaining.size();
-			for (auto action_type : action_group)
-			{
-				std::vector<Unit *> taking_action{std::move(units_to_act[action_type])};
+			ParkUntil(*unit, unit->ready_tick);
+		}
+	}
 
-				for (auto * p_unit : taking_action)
-				{
-					Unit & unit = *p_unit;
-					Action_Result result = UnitTakeAction(unit);
-					switch(result)
-					{
-					case Action_Result::Waiting:
-						units_remaining.erase(unit.id);
-						continue;
-					case Action_Result::Success:
-						units_remaining.erase(unit.id);
-						// each action is only done a single time
-						// and repeat actions need to be handled by commands
-						unit.pending.type = Action_Type::Idle;
-						continue;
-					case Action_Result::Retry:
-						AddUnitToAct(unit);
-						continue;
-					case Action_Result::Recompute:
-						// should we no longer evaluate this frame?
-						// otherwise you could potentially get stuck
-						// adding the same unit over and over again
-						// I think it's okay so long as remaining units goes down
-						UpdateUnitAction(unit);
-						AddUnitToAct(unit);
-						continue;
-					}
-				} // for units
-			} // for action type
-		} // while units_remaining
-	} // for action_group
+	for (UnitID id : acting)
+	{
+		Unit * unit = world.GetUnit(id);
+		if (unit != nullptr && unit->wake_tick <= tick)
+		{
+			schedule.Activate(id);
+		}
+	}
 }
 
-Action_Result Game::UnitTakeAction(Unit & unit)
+Action_Result Game::GatherIntent(const Unit & unit, Action_Intent & intent)
 {
+	intent.unit = unit.id;
+	intent.type = unit.pending.type;
 	if (unit.pending.type == Action_Type::Nothing
 		|| unit.pending.type == Action_Type::Idle)
 	{
 		// consider recompute here
 		return Action_Result::Success;
 	}
-	if (!Contains(unit.type->actions, unit.pending.type))
+	const Action_Rules & action_rules = unit.type->Action(unit.pending.type);
+	if (!action_rules.available)
 	{
 		return Action_Result::Recompute;
 	}
-	Action_Settings & action_settings = unit.type->actions[unit.pending.type];
-	Ticks cooldown = SecondsToTicks(action_settings.cooldown);
-	Ticks max_last_tick_same {-1 * cooldown.value};
-	Ticks max_next_tick_any {-1};
-	for (auto & pair : unit.history)
-	{
-		if (pair.first == unit.pending.type
-			&& max_last_tick_same < pair.second)
-		{
-			max_last_tick_same = pair.second;
-		}
-		int next_tick_any = pair.second.value
-			+ SecondsToTicks(
-				unit.type->actions[pair.first].duration
-			).value;
-		if (next_tick_any > max_next_tick_any.value)
-		{
-			max_next_tick_any.value = next_tick_any;
-		}
-	}
-
-	Ticks next_tick_same { max_last_tick_same.value
-		+ SecondsToTicks(
-			unit.type->actions[unit.pending.type].cooldown
-		).value
-	};
-
-	if (max_next_tick_any.value > tick.value
-		|| next_tick_same.value > tick.value)
+	if (ActionReadyTick(unit) > tick)
 	{
 		return Action_Result::Waiting;
 	}
 
-	if (action_settings.cost > unit.energy)
+	if (action_rules.cost > unit.energy)
 	{
 		// should there be a distinct result for not enough energy?
 		// or should we just wait until we can?
 		return Action_Result::Waiting;
 	}
 
-	Energy magnitude = action_settings.magnitude;
-	Unit * target = nullptr;
+	intent.magnitude = action_rules.magnitude;
+	const Unit * target = nullptr;
 	if (unit.pending.target)
 	{
 		target = world.GetUnit(unit.pending.target.value());
@@ -406,49 +452,58 @@ Action_Result Game::UnitTakeAction(Unit & unit)
 		{
 			return Action_Result::Recompute;
 		}
-
-		if (Contains(target->type->targeted_modifiers, unit.pending.type))
-		{
-			magnitude.value += target->type->targeted_modifiers[unit.pending.type].amount.value;
-		}
+		intent.target = target->id;
+		intent.magnitude.value += target->type->TargetedModifier(unit.pending.type).value;
 	}
 
-	// check for unique failures and take unique action steps
+	// check for unique failures against the state at the start of the tick
 	switch(unit.pending.type)
 	{
 	case Action_Type::Nothing:
 	case Action_Type::Idle:
 		return Action_Result::Recompute;
 	case Action_Type::Attack:
-		target->energy.value -= magnitude.value;
+		if (target == nullptr)
+		{
+			return Action_Result::Recompute;
+		}
 		break;
 	case Action_Type::Heal:
-		if (target->energy.value >= target->type->max_energy.value)
+		if (target == nullptr
+			|| target->energy.value >= target->type->max_energy.value)
 		{
 			// consider Retry?
 			return Action_Result::Recompute;
 		}
-		target->energy.value += magnitude.value;
 		break;
 	case Action_Type::Reproduce:
 	{
-		Map<Unit_Type, int> neighbors;
-		Map<Unit_Type, Point> type_positions;
-		Unit_Type last_neighbor_type {-1};
+		if (world.NeighborCount(unit.position) == 8)
+		{
+			// consider Retry if in group with Move and unit is going to move;
+			return Action_Result::Recompute;
+		}
+		std::array<int, unit_type_count> neighbors{};
+		std::array<std::optional<Point>, unit_type_count> type_positions;
+		std::optional<Unit_Type> last_neighbor_type;
 		std::vector<Point> free_spaces;
 		for (auto & pos : unit.position.GetNeighbors())
 		{
-			if (Contains(world.positions, pos))
+			if (!world.InBounds(pos))
+			{
+				continue;
+			}
+			if (world.IsOccupied(pos))
 			{
-				Unit * neighbor = world.GetUnit(world.positions[pos]);
-				neighbors[neighbor->type->type] += 1;
+				const Unit * neighbor = world.GetUnit(world.GetUnitIDAt(pos));
+				neighbors[static_cast<int>(neighbor->type->type)] += 1;
 				last_neighbor_type = neighbor->type->type;
 			}
 			else
 			{
-				if (last_neighbor_type != Unit_Type{-1})
+				if (last_neighbor_type)
 				{
-					type_positions[last_neighbor_type] = pos;
+					type_positions[static_cast<int>(last_neighbor_type.value())] = pos;
 				}
 				free_spaces.push_back(pos);
 			}
@@ -458,127 +513,385 @@ Action_Result Game::UnitTakeAction(Unit & unit)
 			// consider Retry if in group with Move and unit is going to move;
 			return Action_Result::Recompute;
 		}
-		Unit_Type most_common_type = GetRandomUnitType(random_generator);
+		// without neighbors the type is drawn when the intent resolves
+		// ties go to the lowest Unit_Type so the choice doesn't depend on map order
 		int max_neighbor_type_count = 0;
-		for (auto & pair : neighbors)
+		for (int type = 0; type < unit_type_count; type++)
 		{
-			if (pair.second > max_neighbor_type_count)
+			if (neighbors[type] > max_neighbor_type_count)
 			{
-				max_neighbor_type_count = pair.second;
-				most_common_type = pair.first;
+				max_neighbor_type_count = neighbors[type];
+				intent.spawn_type = static_cast<Unit_Type>(type);
 			}
 		}
-		Point position = free_spaces[0];
-		if (Contains(type_positions, most_common_type))
+		intent.destination = free_spaces[0];
+		if (intent.spawn_type
+			&& type_positions[static_cast<int>(intent.spawn_type.value())])
 		{
-			position = type_positions[most_common_type];
+			intent.destination = type_positions[static_cast<int>(intent.spawn_type.value())].value();
 		}
-		auto result = SpawnUnit(unit.player, most_common_type, position);
-		if (result.IsError())
+		break;
+	}
+	case Action_Type::Move:
+		if (!unit.pending.location
+			|| !unit.position.IsCardinalNeighbor(unit.pending.location.value()))
 		{
 			return Action_Result::Recompute;
 		}
-		// todo: emit event for unit spawned
+		if (!world.InBounds(unit.pending.location.value()))
+		{
+			return Action_Result::Recompute;
+		}
+		intent.destination = unit.pending.location.value();
 		break;
 	}
-	case Action_Type::Move:
-		if (!unit.position.IsCardinalNeighbor(unit.pending.location.value()))
+
+	return Action_Result::Success;
+}
+
+void Game::ResolveIntents(std::vector<Action_Intent> & intents)
+{
+	Scoped_Timer timer{profiler, Profile_Phase::ResolveIntents};
+	// intents are in unit id order, and every rule below picks the same
+	// winner regardless of which intent it is looking at first
+	Map<UnitID, int> intent_index;
+	// tiles entered by moves and reproduction, the lowest unit id wins a contested tile
+	Map<Point, UnitID> claims;
+	for (int i = 0; i < static_cast<int>(intents.size()); i++)
+	{
+		Action_Intent & intent = intents[i];
+		intent_index[intent.unit] = i;
+		if (intent.type != Action_Type::Move
+			&& intent.type != Action_Type::Reproduce)
 		{
-			return Action_Result::Recompute;
+			continue;
 		}
-		bool success = world.MoveUnit(unit.id, unit.pending.location.value());
-		if (!success)
+		auto found = claims.find(intent.destination);
+		if (found == claims.end()
+			|| intent.unit.value < found->second.value)
 		{
-			// if we use Recompute here, chains of units moving in a line
-			// could either all move together or one by one
-			// alternatively use pre/post tick states to make this behavior consistent
-			return Action_Result::Retry;
+			claims[intent.destination] = intent.unit;
 		}
+	}
 
-		// @Feature special case here for swapping?
-		// how to do so in context tracking which units have already updated
-		break;
+	// a move into an occupied tile succeeds if the occupant moves out,
+	// so follow the chain of occupants until it ends in an empty tile,
+	// a unit that stays put, or loops back on itself.
+	// every unit on a loop won its claim, so the whole loop moves together
+	// which also covers two units swapping
+	enum class Entry_State { Unknown, Visiting, Enters, Blocked };
+	std::vector<Entry_State> states(intents.size(), Entry_State::Unknown);
+	std::vector<int> path;
+	auto CanEnter = [&](int start)
+	{
+		path.clear();
+		Entry_State result = Entry_State::Blocked;
+		int current = start;
+		while (true)
+		{
+			if (states[current] == Entry_State::Enters
+				|| states[current] == Entry_State::Blocked)
+			{
+				result = states[current];
+				break;
+			}
+			if (states[current] == Entry_State::Visiting)
+			{
+				result = Entry_State::Enters;
+				break;
+			}
+			states[current] = Entry_State::Visiting;
+			path.push_back(current);
+			const Action_Intent & intent = intents[current];
+			if (claims[intent.destination] != intent.unit)
+			{
+				result = Entry_State::Blocked;
+				break;
+			}
+			UnitID occupant = world.GetUnitIDAt(intent.destination);
+			if (occupant == no_unit)
+			{
+				result = Entry_State::Enters;
+				break;
+			}
+			auto found = intent_index.find(occupant);
+			if (intent.type != Action_Type::Move
+				|| found == intent_index.end()
+				|| intents[found->second].type != Action_Type::Move)
+			{
+				result = Entry_State::Blocked;
+				break;
+			}
+			current = found->second;
+		}
+		for (int i : path)
+		{
+			states[i] = result;
+		}
+		return result == Entry_State::Enters;
+	};
+
+	std::vector<std::pair<UnitID, Point>> moves;
+	std::vector<int> spawns;
+	for (int i = 0; i < static_cast<int>(intents.size()); i++)
+	{
+		Action_Intent & intent = intents[i];
+		intent.result = Action_Result::Success;
+		switch (intent.type)
+		{
+		case Action_Type::Move:
+			if (!CanEnter(i))
+			{
+				// keeps its pending move and tries again next tick
+				intent.result = Action_Result::Retry;
+				events.Push({
+					Event_Type::Blocked,
+					tick,
+					intent.unit,
+					world.GetUnit(intent.unit)->player,
+					no_unit,
+					intent.destination});
+				continue;
+			}
+			moves.emplace_back(intent.unit, intent.destination);
+			break;
+		case Action_Type::Reproduce:
+			if (!CanEnter(i))
+			{
+				intent.result = Action_Result::Retry;
+				continue;
+			}
+			spawns.push_back(i);
+			break;
+		default:
+			break;
+		}
 	}
 
-	// assume success here, common items for taking the action
-	unit.history[unit.pending.type] = tick;
-	unit.energy.value -= action_settings.cost.value;
+	world.MoveUnits(moves);
+	for (auto & [id, destination] : moves)
+	{
+		events.Push({Event_Type::Move, tick, id, world.GetUnit(id)->player, no_unit, destination});
+	}
 
-	return Action_Result::Success;
+	// attack and heal are simultaneous: all checks used the starting state
+	// and the deltas commute, so application order doesn't matter
+	for (auto & intent : intents)
+	{
+		if (intent.result != Action_Result::Success)
+		{
+			continue;
+		}
+		Unit & unit = *world.GetUnit(intent.unit);
+		const Action_Rules & action_rules = unit.type->Action(intent.type);
+		switch (intent.type)
+		{
+		case Action_Type::Attack:
+			world.AddEnergy(*world.GetUnit(intent.target), -intent.magnitude.value);
+			events.Push({
+				Event_Type::Attack,
+				tick,
+				unit.id,
+				unit.player,
+				intent.target,
+				unit.position,
+				intent.magnitude});
+			break;
+		case Action_Type::Heal:
+			// over healing is capped in EnergyTick
+			world.AddEnergy(*world.GetUnit(intent.target), intent.magnitude.value);
+			events.Push({
+				Event_Type::Heal,
+				tick,
+				unit.id,
+				unit.player,
+				intent.target,
+				unit.position,
+				intent.magnitude});
+			break;
+		default:
+			break;
+		}
+
+		Unit_Orders & orders = world.GetOrders(unit);
+		orders.cooldown_until[static_cast<int>(intent.type)] = Ticks{
+			tick.value + action_rules.cooldown.value
+		};
+		unit.ready_tick = std::max(
+			unit.ready_tick,
+			Ticks{tick.value + action_rules.duration.value});
+		world.AddEnergy(unit, -action_rules.cost.value);
+		// each action is only done a single time
+		// and repeat actions need to be handled by commands
+		world.SetPending(unit, Action_Step{Action_Type::Idle, {}, {}});
+	}
+
+	// spawned last so new units never block this tick's moves
+	for (int i : spawns)
+	{
+		Action_Intent & intent = intents[i];
+		Random_Stream stream = random.Stream(Random_Purpose::Spawn_Type, tick, intent.unit);
+		Unit_Type spawn_type = intent.spawn_type
+			? intent.spawn_type.value()
+			: GetRandomUnitType(stream);
+		PlayerID player = world.GetUnit(intent.unit)->player;
+		auto result = SpawnUnit(player, spawn_type, intent.destination, intent.unit);
+		if (result.IsError())
+		{
+			result.GetError().Log();
+		}
+	}
 }
 
+Ticks Game::ActionReadyTick(const Unit & unit)
+{
+	Unit_Orders & orders = world.GetOrders(unit);
+	return std::max(
+		unit.ready_tick,
+		orders.cooldown_until[static_cast<int>(unit.pending.type)]);
+}
 
 void Game::EnergyTick()
 {
-	Ticks crowded_decay_time {SecondsToTicks(settings.crowded_decay.second).value};
-	Energy crowded_decay_amount = settings.crowded_decay.first;
-	Set<UnitID> exhausted;
-	for (auto & pair : world.units)
+	Scoped_Timer timer{profiler, Profile_Phase::EnergyTick};
+	Ticks crowded_decay_time = rules->crowded_decay_period;
+	Energy crowded_decay_amount = rules->crowded_decay_amount;
+
+	// Energy recharge
+	// phased by spawn tick so units of a type don't all recharge on the same tick
+	recharges.TakeDue(tick, [&](UnitID id, Ticks)
 	{
-		Unit & unit = pair.second;
-		// Energy recharge
-		Ticks recharge_frequency = SecondsToTicks(unit.type->recharge_rate.second);
-		Energy recharge_amount = unit.type->recharge_rate.first;
-		// @Feature SpawnTime in order to offset/stagger recharges?
-		if (tick.value % recharge_frequency.value == 0)
+		Unit * unit = world.GetUnit(id);
+		if (unit == nullptr)
 		{
-			unit.energy.value += recharge_amount.value;
+			// died, stop recharging
+			return;
 		}
+		world.AddEnergy(*unit, unit->type->recharge_amount.value);
+		recharges.Add(id, Ticks{tick.value + unit->type->recharge_period.value});
+	});
 
-		// Energy cap
-		if (unit.energy.value > unit.type->max_energy.value)
+	// only units healed or recharged can be over the cap
+	// and only units that lost energy can be exhausted
+	std::vector<UnitID> changed;
+	std::swap(changed, world.energy_changed);
+
+	// Energy cap
+	for (UnitID id : changed)
+	{
+		Unit * unit = world.GetUnit(id);
+		if (unit != nullptr
+			&& unit->energy.value > unit->type->max_energy.value)
 		{
-			unit.energy = unit.type->max_energy;
+			world.SetEnergy(*unit, unit->type->max_energy);
 		}
+	}
 
-		// Crowding
-		int neighbor_count = 0;
-		for (auto & pos : unit.position.GetNeighbors())
+	// Crowding
+	// units join when their tile reaches the threshold and leave once they've recovered
+	for (Point p : world.chunks.newly_crowded)
+	{
+		Unit * unit = world.GetUnit(world.GetUnitIDAt(p));
+		if (unit != nullptr && !unit->crowding)
 		{
-			if (Contains(world.positions, pos))
-			{
-				neighbor_count += 1;
-			}
+			unit->crowding = true;
+			crowding.push_back(unit->id);
 		}
-		if (neighbor_count >= settings.crowded_threshold.value)
+	}
+	world.chunks.newly_crowded.clear();
+	std::size_t still_crowding = 0;
+	for (UnitID id : crowding)
+	{
+		Unit * unit = world.GetUnit(id);
+		if (unit == nullptr)
 		{
-			unit.crowded_duration.value++;
-			if (unit.crowded_duration.value >= crowded_decay_time.value)
+			continue;
+		}
+		int neighbor_count = world.NeighborCount(unit->position);
+		if (neighbor_count >= rules->crowded_threshold.value)
+		{
+			unit->crowded_duration.value++;
+			if (unit->crowded_duration.value >= crowded_decay_time.value)
 			{
-				unit.energy.value -= crowded_decay_amount.value;
-				unit.crowded_duration.value -= crowded_decay_time.value;
+				world.AddEnergy(*unit, -crowded_decay_amount.value);
+				unit->crowded_duration.value -= crowded_decay_time.value;
 			}
 		}
 		else
 		{
-			unit.crowded_duration.value--;
-			if (unit.crowded_duration.value < 0)
+			unit->crowded_duration.value--;
+			if (unit->crowded_duration.value < 0)
 			{
-				unit.crowded_duration.value = 0;
+				unit->crowded_duration.value = 0;
 			}
 		}
+		if (neighbor_count >= rules->crowded_threshold.value
+			|| unit->crowded_duration.value > 0)
+		{
+			crowding[still_crowding++] = id;
+		}
+		else
+		{
+			unit->crowding = false;
+		}
+	}
+	crowding.resize(still_crowding);
+
+	// Exhaustion
+	changed.insert(changed.end(), world.energy_changed.begin(), world.energy_changed.end());
+	world.energy_changed.clear();
+	for (UnitID id : changed)
+	{
+		Unit * unit = world.GetUnit(id);
+		if (unit != nullptr && unit->energy.value < 0)
+		{
+			KillUnit(id);
+		}
+	}
+}
 
-		// Exhaustion
-		if (unit.energy.value < 0)
+void Game::RecordStateHash()
+{
+	Scoped_Timer timer{profiler, Profile_Phase::RecordStateHash};
+	world.hash.Set(Hash_Field::Random, State_Hash::Mix(random.seed));
+#ifdef Debug
+	// the incremental hash is only as good as every mutation going through World
+	State_Hash computed = world.ComputeHash();
+	for (int field = 0; field < hash_field_count; field++)
+	{
+		if (computed.fields[field] != world.hash.fields[field])
+		{
+			Error(std::string("Incremental state hash drifted from the state in field ")
+				+ GetName(static_cast<Hash_Field>(field))).Log();
+		}
+	}
+#endif
+	if (hash_recorder)
+	{
+		hash_recorder->Record(tick, world.hash);
+	}
+	if (replay_recorder)
+	{
+		Replay_Keyframe * keyframe = replay_recorder->EndTick(tick, world.hash);
+		if (keyframe != nullptr)
 		{
-			exhausted.insert(unit.id);
+			// so a replay that was just loaded can seek without simulating up to here
+			keyframe->state = SaveState(true);
 		}
 	}
-	RemoveUnits(exhausted);
 }
 
-void Game::Render(Tigr * screen, const Dimensions & world_portion)
+const State_Hash & Game::GetStateHash() const
 {
-	world.Render(screen, world_portion, players[local_player].camera_location, local_player);
-	// todo: render command card, buffer
+	return world.hash;
 }
 
-bool Game::IsOver()
+bool Game::IsOver() const
 {
 	Set<PlayerID> players_with_units;
-	for(auto & pair : world.units)
+	for(const Unit & unit : world.units)
 	{
-		players_with_units.insert(pair.second.player);
+		players_with_units.insert(unit.player);
 		if (players_with_units.size() > 1)
 		{
 			return false;
@@ -588,38 +901,70 @@ bool Game::IsOver()
 }
 
 
-ErrorOr<UnitID> Game::SpawnUnit(PlayerID player, Unit_Type type, Point position)
+ErrorOr<UnitID> Game::SpawnUnit(PlayerID player, Unit_Type type, Point position, UnitID parent)
 {
 	Unit u;
-	u.type = &(settings.unit_types[type]);
-	u.id = next_unit_id;
+	u.type = &rules->Unit(type);
 	u.player = player;
 	u.position = position;
 	u.energy = u.type->starting_energy;
+	u.ready_tick = tick;
+	u.wake_tick = tick;
 	// todo: idle command, pending action
 
-	bool success = world.AddUnit(std::move(u), position);
-	if (!success)
+	Unit * added = world.AddUnit(std::move(u), position);
+	if (added == nullptr)
 	{
 		return Error("Couldn't add unit to world");
 	}
-	UnitID id = next_unit_id;
-	next_unit_id.value++;
-	return id;
+	Player & owner = players[player];
+	world.GetOrders(*added).idle_command = owner.idle_command
+		? owner.idle_command
+		: value_ptr<Action_Command>{new Action_Command{}};
+	// starts acting next tick
+	schedule.Activate(added->id);
+	recharges.Add(added->id, Ticks{tick.value + added->type->recharge_period.value});
+	events.Push({Event_Type::Spawn, tick, added->id, player, parent, position});
+	return added->id;
 }
 
-void Game::RemoveUnits(Set<UnitID> units)
+void Game::KillUnit(UnitID unit)
 {
-	world.RemoveUnits(units);
+	dying.push_back(unit);
+}
+
+void Game::RemoveDeadUnits()
+{
+	Scoped_Timer timer{profiler, Profile_Phase::RemoveDeadUnits};
+	if (dying.empty())
+	{
+		return;
+	}
+	// sorted so death events are in id order and each player can binary search
+	std::sort(dying.begin(), dying.end(), [](UnitID a, UnitID b)
+	{
+		return a.value < b.value;
+	});
+	dying.erase(std::unique(dying.begin(), dying.end()), dying.end());
+	for (auto id : dying)
+	{
+		Unit * unit = world.GetUnit(id);
+		if (unit != nullptr)
+		{
+			events.Push({Event_Type::Death, tick, id, unit->player, no_unit, unit->position, unit->energy});
+		}
+	}
+	world.RemoveUnits(dying);
 	for (auto & pair : players)
 	{
-		pair.second.RemoveUnits(units);
+		pair.second.RemoveUnits(dying);
 	}
+	dying.clear();
 }
 
 Ticks Game::SecondsToTicks(Seconds s)
 {
-	return Ticks{ Round(s.value * settings.speed.value) };
+	return rules->SecondsToTicks(s);
 }
 
 } // namespace Brushlink
@@ -2,7 +2,6 @@
 #ifndef BRUSHLINK_GAME_H
 #define BRUSHLINK_GAME_H
 
-#include <random>
 #include <utility>
 
 #include "BuiltinTypedefs.h"
@@ -10,11 +9,23 @@
 #include "Game_Basic_Types.h"
 #include "Player.h"
 #include "World.h"
-#include "Input.h"
+#include "Action_Schedule.h"
+#include "Ruleset.h"
+#include "Worker_Pool.h"
+#include "Profiler.h"
+#include "Event.h"
+#include "Random.h"
+#include "Replay.h"
 
 namespace Brushlink
 {
 
+// see app/Input.h, which only the app includes
+struct Key_Changes;
+struct Modifiers_State;
+struct Mouse_State;
+enum class Input_Result;
+
 struct GameSettings
 {
 	Map<PlayerID, Player_Settings> player_settings;
@@ -29,6 +40,8 @@ struct GameSettings
 	Ticks speed {12}; // per second
 	Number crowded_threshold {6}; // number of neighbors at which we start decaying
 	std::pair<Energy, Seconds> crowded_decay{{1}, {1.0}};
+	World_Settings world_settings;
+	uint64_t seed = 0; // every random draw in the game follows from this
 
 	static const GameSettings default_settings;
 };
@@ -36,23 +49,73 @@ struct GameSettings
 struct Game
 {
 	GameSettings settings;
+	// compiled from settings in Initialize unless one was shared in
+	std::shared_ptr<const Ruleset> rules;
 	World world;
 	Map<PlayerID, Player> players;
 
 	PlayerID local_player{-1};
 
-	std::random_device random_seed; // seed
-	std::mt19937 random_generator; // mersene twister from seed
+	Random_Service random;
 
-	UnitID next_unit_id;
 	Ticks tick;
+	Action_Schedule schedule;
+	// each unit recharges every recharge_period ticks counted from when it spawned
+	Timing_Wheel recharges;
+	// units that are crowded or still have crowded_duration to wind down
+	std::vector<UnitID> crowding;
+	// collected during the tick and removed together in RemoveDeadUnits
+	std::vector<UnitID> dying;
+	// applied at the start of the next tick, in the order they were issued
+	std::vector<Issued_Command> issued;
+	Worker_Pool workers; // set to 0 threads when many games already run side by side
+	// set to record the state hash at the end of every tick, see Hash_Recorder
+	std::unique_ptr<Hash_Recorder> hash_recorder;
+	// set by RecordReplay
+	std::unique_ptr<Replay_Recorder> replay_recorder;
+	Profiler profiler;
+	Event_Stream events;
 
 	Game(const GameSettings & settings = GameSettings::default_settings)
 		: settings(settings)
+		, world(settings.world_settings)
+		, random{settings.seed}
 	{ }
 
-	void Initialize();
+	Game(std::shared_ptr<const Ruleset> rules, const GameSettings & settings = GameSettings::default_settings)
+		: settings(settings)
+		, rules(std::move(rules))
+		, world(settings.world_settings)
+		, random{settings.seed}
+	{ }
 
+	void Initialize();
+	// after Initialize, reads the images and draws unit bodies
+	// app only, it's defined with the rest of the drawing in app/Render.cpp
+	void LoadGraphics();
+	// by offset, bottom row first
+	std::vector<std::pair<Point, Unit_Type> > SortedStartingUnits() const;
+
+	// a copy of the game state that shares chunks, unit pages and vision
+	// with this game until one of them writes to them, see World::Fork
+	// take it between ticks, after that it can be advanced on another thread
+	std::unique_ptr<Game> Snapshot();
+
+	// between ticks, see Save_File.h
+	ErrorOr<Success> Save(const std::string & file_name) const;
+	// the bytes of a save file, keyframes leave out what loading can rebuild
+	std::vector<uint8_t> SaveState(bool keyframe = false) const;
+	// settings only supply what isn't game state, such as image files
+	// loaded games are headless, their unit bodies aren't drawn
+	static ErrorOr<std::unique_ptr<Game>> Load(const std::string & file_name, const GameSettings & settings = GameSettings::default_settings);
+	// data must be 8 byte aligned, as a std::vector's is
+	static ErrorOr<std::unique_ptr<Game>> LoadState(const uint8_t * data, std::size_t size, const GameSettings & settings = GameSettings::default_settings);
+
+	// call after Initialize, before the first tick
+	void RecordReplay(int keyframe_interval = Replay::default_keyframe_interval);
+	void Issue(Issued_Command command);
+
+	// app only, see LoadGraphics
 	Input_Result ReceiveInput(
 		const Key_Changes &,
 		const Modifiers_State &,
@@ -64,14 +127,23 @@ struct Game
 	void ProcessPlayerInput();
 	void RunPlayerCoroutines();
 	void AllUnitsTakeAction();
-	Action_Result UnitTakeAction(Unit & unit);
+	// checks the unit's pending action against the current state without changing it
+	Action_Result GatherIntent(const Unit & unit, Action_Intent & intent);
+	void ResolveIntents(std::vector<Action_Intent> & intents);
+	Ticks ActionReadyTick(const Unit & unit);
 	void EnergyTick();
+	void RemoveDeadUnits();
+	void RecordStateHash();
+	const State_Hash & GetStateHash() const;
 
+	// app only, see LoadGraphics
 	void Render(Tigr * screen, const Dimensions & world_portion);
-	bool IsOver();
+	bool IsOver() const;
 
-	ErrorOr<UnitID> SpawnUnit(PlayerID player, Unit_Type unit, Point position);
-	void RemoveUnits(Set<UnitID> units);
+	// parent is the unit that reproduced, if any
+	ErrorOr<UnitID> SpawnUnit(PlayerID player, Unit_Type unit, Point position, UnitID parent = no_unit);
+	// the unit is removed at the end of the tick
+	void KillUnit(UnitID unit);
 
 	Ticks SecondsToTicks(Seconds s);
 	
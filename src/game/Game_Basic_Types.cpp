@@ -1,14 +1,13 @@
 
 #include "Game_Basic_Types.h"
+#include "Random.h"
 
 namespace Brushlink
 {
 
-Unit_Type GetRandomUnitType(std::mt19937 generator)
+Unit_Type GetRandomUnitType(Random_Stream & random)
 {
-	// @Cleanup hardcoded values for min/max unit type
-	std::uniform_int_distribution<> range{0, 2};
-	return static_cast<Unit_Type>(range(generator));
+	return static_cast<Unit_Type>(random.Range(0, unit_type_count - 1));
 };
 
 } // namespace Brushlink
@@ -2,7 +2,6 @@
 #ifndef BRUSHLINK_GAME_BASIC_TYPES_H
 #define BRUSHLINK_GAME_BASIC_TYPES_H
 
-#include <random>
 #include <vector>
 
 #include "BuiltinTypedefs.h"
@@ -26,6 +25,9 @@ struct UnitIDTag
 };
 using UnitID = NamedType<int, UnitIDTag>;
 
+// sentinel for tiles and lookups that have no unit
+inline const UnitID no_unit{-1};
+
 struct Unit_Group
 {
 	Farb::Set<UnitID> members;
@@ -38,6 +40,8 @@ enum class Unit_Type
 	Attacker,
 };
 
+constexpr int unit_type_count = static_cast<int>(Unit_Type::Attacker) + 1;
+
 enum class Unit_Attribute
 {
 	Energy,
@@ -45,7 +49,9 @@ enum class Unit_Attribute
 	Vision_Radius,
 };
 
-Unit_Type GetRandomUnitType(std::mt19937 generator);
+struct Random_Stream;
+
+Unit_Type GetRandomUnitType(Random_Stream & random);
 
 } // namespace Brushlink
 
@@ -0,0 +1,70 @@
+
+#include "Game_Preview.h"
+
+#include <chrono>
+
+namespace Brushlink
+{
+
+Game_Preview::~Game_Preview()
+{
+	Cancel();
+}
+
+void Game_Preview::Start(Game & live, int ticks, std::function<void(Game &)> setup)
+{
+	Cancel();
+	game = live.Snapshot();
+	cancelled = false;
+	ticks_done = 0;
+	running = std::async(std::launch::async, [this, ticks, setup = std::move(setup)]()
+	{
+		if (setup)
+		{
+			setup(*game);
+		}
+		for (int i = 0; i < ticks && !cancelled; i++)
+		{
+			game->Tick();
+			ticks_done++;
+		}
+	});
+}
+
+void Game_Preview::Cancel()
+{
+	if (!running.valid())
+	{
+		return;
+	}
+	// stops after the tick in progress
+	cancelled = true;
+	running.wait();
+	running = {};
+	game.reset();
+}
+
+bool Game_Preview::IsDone()
+{
+	if (!running.valid())
+	{
+		return game != nullptr;
+	}
+	if (running.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+	{
+		return false;
+	}
+	running.get();
+	return true;
+}
+
+const Game * Game_Preview::Result()
+{
+	if (!IsDone() || cancelled)
+	{
+		return nullptr;
+	}
+	return game.get();
+}
+
+} // namespace Brushlink
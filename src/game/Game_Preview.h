@@ -0,0 +1,42 @@
+#pragma once
+#ifndef BRUSHLINK_GAME_PREVIEW_H
+#define BRUSHLINK_GAME_PREVIEW_H
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "Game.h"
+
+namespace Brushlink
+{
+
+// advances a snapshot of the live game on a background thread
+// so a player can see what a command would do without touching the match
+// starting a new preview cancels the one in flight, so it's fine to restart on every keystroke
+struct Game_Preview
+{
+	std::unique_ptr<Game> game;
+	std::future<void> running;
+	std::atomic<bool> cancelled{false};
+	std::atomic<int> ticks_done{0};
+
+	Game_Preview() = default;
+	~Game_Preview();
+
+	Game_Preview(const Game_Preview &) = delete;
+	Game_Preview & operator=(const Game_Preview &) = delete;
+
+	// the snapshot is taken here, so call it between the live game's ticks
+	// setup runs on the background thread before the first tick, e.g. to give the command
+	void Start(Game & live, int ticks, std::function<void(Game &)> setup);
+	void Cancel();
+	bool IsDone();
+	// nullptr until the preview has advanced all of its ticks
+	const Game * Result();
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_GAME_PREVIEW_H
@@ -1,4 +1,5 @@
 #include "Location.h"
+#include "Circle_Stencil.h"
 
 namespace Brushlink
 {
@@ -7,19 +8,7 @@ Area Area::Circle(Point center, float radius)
 {
 	Area a;
 	a.points.insert(center);
-	float radius_squared = radius * radius;
-	int bounds = static_cast<int>(radius + 1.0);
-	for(int x = -bounds; x <= bounds; x++)
-	{
-		for (int y = -bounds; y <= bounds; y++)
-		{
-			if (static_cast<float>(x * x + y * y) > radius_squared)
-			{
-				continue;
-			}
-			a.points.insert({center.x + x, center.y + y});
-		}
-	}
+	Circle_Stencil::Get(radius).StampInto(a, center);
 	return a;
 }
 
@@ -20,24 +20,24 @@ struct Point
 	int x = 0;
 	int y = 0;
 
-	inline int CardinalDistance(Point other)
+	inline int CardinalDistance(Point other) const
 	{
 		return abs(other.x - x) + abs(other.y - y);
 	}
 
-	inline bool IsNeighbor(Point other)
+	inline bool IsNeighbor(Point other) const
 	{
 		return abs(other.x - x) <= 1
 			&& abs(other.y - y) <= 1
 			&& (other.y != y || other.x != x);
 	}
 
-	inline bool IsCardinalNeighbor(Point other)
+	inline bool IsCardinalNeighbor(Point other) const
 	{
 		return CardinalDistance(other) == 1;
 	}
 
-	inline std::vector<Point> GetCardinalNeighbors()
+	inline std::vector<Point> GetCardinalNeighbors() const
 	{
 		return {
 			{x + 1, y},
@@ -47,7 +47,7 @@ struct Point
 		};
 	}
 
-	inline std::vector<Point> GetNeighbors()
+	inline std::vector<Point> GetNeighbors() const
 	{
 		std::vector<Point> neighbors;
 		for (int i = -1; i <= 1; i++)
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef BRUSHLINK_PAGED_ARRAY_H
+#define BRUSHLINK_PAGED_ARRAY_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "Cow_Owner.h"
+
+namespace Brushlink
+{
+
+// dense array split into fixed size pages
+// appending never moves existing elements, so pointers survive spawns
+// pages are copy on write, see Cow_Owner.h
+// the first write to a page after a Fork moves it, so don't hold pointers across one
+// reads through a const Paged_Array never copy, so read through one where nothing is written
+template<typename T>
+struct Paged_Array
+{
+	static constexpr int page_bits = 10;
+	static constexpr int page_size = 1 << page_bits;
+
+	std::vector<std::shared_ptr<T[]>> pages;
+	std::vector<uint32_t> page_owners;
+	uint32_t owner = 0;
+	int size = 0;
+
+	inline T & operator[](int index)
+	{
+		int page = index >> page_bits;
+		if (page_owners[page] != owner)
+		{
+			Unshare(page);
+		}
+		return pages[page][index & (page_size - 1)];
+	}
+
+	inline const T & operator[](int index) const
+	{
+		return pages[index >> page_bits][index & (page_size - 1)];
+	}
+
+	T & Append(T && value)
+	{
+		if (size == static_cast<int>(pages.size()) * page_size)
+		{
+			pages.emplace_back(new T[page_size], std::default_delete<T[]>{});
+			page_owners.push_back(owner);
+		}
+		T & slot = (*this)[size];
+		slot = std::move(value);
+		size++;
+		return slot;
+	}
+
+	void PopBack()
+	{
+		size--;
+		(*this)[size] = T{};
+	}
+
+	void Fork()
+	{
+		owner = NewCowOwner();
+	}
+
+	void Unshare(int page)
+	{
+		std::shared_ptr<T[]> copy{new T[page_size], std::default_delete<T[]>{}};
+		std::copy_n(pages[page].get(), page_size, copy.get());
+		pages[page] = std::move(copy);
+		page_owners[page] = owner;
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_PAGED_ARRAY_H
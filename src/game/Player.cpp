@@ -1,5 +1,7 @@
 #include "Player.h"
 
+#include <algorithm>
+
 using namespace Command;
 
 namespace Brushlink
@@ -18,21 +20,176 @@ Player Player::FromSettings(const Player_Settings & settings, PlayerID id, Point
 		starting_location,
 		Point{0,0}, // camera location, is this bottom_left or center?
 		Command::Context{}, // @Feature Commands
-		{}
+		{}, // command_groups
+		{} // idle_command
 	};
 	return p;
 }
 
-void Player::RemoveUnits(Set<UnitID> unit_ids)
+void Player::AddToCommandGroup(Number group, UnitID unit)
+{
+	if (command_groups[group].members.insert(unit).second)
+	{
+		unit_references[unit].groups.insert(group);
+	}
+}
+
+void Player::SetCommandGroup(Number group, Unit_Group units)
+{
+	auto found = command_groups.find(group);
+	if (found != command_groups.end())
+	{
+		for (auto id : found->second.members)
+		{
+			if (units.members.count(id) != 0)
+			{
+				continue;
+			}
+			auto references = unit_references.find(id);
+			if (references == unit_references.end())
+			{
+				continue;
+			}
+			references->second.groups.erase(group);
+			if (references->second.IsEmpty())
+			{
+				unit_references.erase(references);
+			}
+		}
+	}
+	for (auto id : units.members)
+	{
+		unit_references[id].groups.insert(group);
+	}
+	command_groups[group] = std::move(units);
+}
+
+// calls f with every unit named in a value, possibly more than once
+template<typename F>
+static void ForEachUnitIn(const std::vector<Variant> & value, F && f)
+{
+	for (auto & element : value)
+	{
+		if (auto * id = std::get_if<UnitID>(&element))
+		{
+			f(*id);
+		}
+		else if (auto * group = std::get_if<Unit_Group>(&element))
+		{
+			for (auto member : group->members)
+			{
+				f(member);
+			}
+		}
+	}
+}
+
+void Player::IndexValue(ValueName name, const std::vector<Variant> & value)
+{
+	ForEachUnitIn(value, [&](UnitID id)
+	{
+		unit_references[id].values.insert(name);
+	});
+}
+
+void Player::UnindexValue(ValueName name, const std::vector<Variant> & value)
+{
+	ForEachUnitIn(value, [&](UnitID id)
+	{
+		auto references = unit_references.find(id);
+		if (references == unit_references.end())
+		{
+			return;
+		}
+		references->second.values.erase(name);
+		if (references->second.IsEmpty())
+		{
+			unit_references.erase(references);
+		}
+	});
+}
+
+void Player::RemoveUnits(const std::vector<UnitID> & unit_ids)
 {
-	// todo: remove from command context stored variables
-	// and from per-tick evaluations, if necessary
-	for (auto & pair : command_groups)
+	auto IsRemoved = [&](UnitID id)
 	{
-		for (auto & id : unit_ids)
+		return std::binary_search(unit_ids.begin(), unit_ids.end(), id,
+			[](UnitID a, UnitID b) { return a.value < b.value; });
+	};
+
+	// gather everything the dead units touched, then visit each group or value once
+	// and only erase the ids that were indexed under it
+	std::vector<std::pair<Number, UnitID> > group_removals;
+	std::vector<std::pair<ValueName, UnitID> > value_removals;
+	for (auto id : unit_ids)
+	{
+		auto found = unit_references.find(id);
+		if (found == unit_references.end())
+		{
+			continue;
+		}
+		Unit_References & references = found->second;
+		for (auto group : references.groups)
+		{
+			group_removals.emplace_back(group, id);
+		}
+		for (auto & name : references.values)
+		{
+			value_removals.emplace_back(name, id);
+		}
+		unit_references.erase(found);
+	}
+
+	auto ByKey = [](auto & a, auto & b)
+	{
+		return a.first.value < b.first.value;
+	};
+
+	std::sort(group_removals.begin(), group_removals.end(), ByKey);
+	for (std::size_t i = 0; i < group_removals.size(); )
+	{
+		auto found = command_groups.find(group_removals[i].first);
+		std::size_t end = i;
+		for (; end < group_removals.size()
+			&& group_removals[end].first == group_removals[i].first; end++)
+		{
+			if (found != command_groups.end())
+			{
+				found->second.members.erase(group_removals[end].second);
+			}
+		}
+		i = end;
+	}
+
+	std::sort(value_removals.begin(), value_removals.end(), ByKey);
+	auto & stored = root_command_context.values;
+	for (std::size_t i = 0; i < value_removals.size(); )
+	{
+		auto found = stored.find(value_removals[i].first);
+		std::size_t end = i;
+		while (end < value_removals.size()
+			&& value_removals[end].first == value_removals[i].first)
+		{
+			end++;
+		}
+		if (found != stored.end())
 		{
-			pair.second.members.erase(id);
+			std::vector<Variant> & value = found->second;
+			value.erase(std::remove_if(value.begin(), value.end(), [&](Variant & element)
+			{
+				if (auto * group = std::get_if<Unit_Group>(&element))
+				{
+					for (std::size_t r = i; r < end; r++)
+					{
+						group->members.erase(value_removals[r].second);
+					}
+					return false;
+				}
+				auto * id = std::get_if<UnitID>(&element);
+				return id != nullptr && IsRemoved(*id);
+			}), value.end());
 		}
+		i = end;
 	}
 }
 
@@ -11,6 +11,7 @@
 #include "Player_Graphics.h"
 #include "Location.h"
 #include "Game_Basic_Types.h"
+#include "Event.h"
 #include "Command.h"
 #include "Context.h"
 
@@ -48,6 +49,20 @@ struct Player_Settings
 	// todo: make this load from a file
 };
 
+// everything of one player's that names a unit
+// so removing the unit only visits these instead of every group and value
+struct Unit_References
+{
+	// sets, so setting the same group or value again doesn't grow them
+	Set<Number> groups;
+	Set<ValueName> values; // globals in root_command_context
+
+	inline bool IsEmpty() const
+	{
+		return groups.empty() && values.empty();
+	}
+};
+
 // game time modified values
 struct Player
 {
@@ -68,12 +83,27 @@ struct Player
 
 	Command::Context root_command_context;
 	Table<Number, Unit_Group> command_groups;
+	// given to each of this player's new units, they do nothing when idle if empty
+	// scripted players set this instead of issuing commands
+	value_ptr<Action_Command> idle_command;
+	// kept exact as groups and values are overwritten
+	// so it only grows with the units that are actually referenced
+	Table<UnitID, Unit_References> unit_references;
 
-	// todo: command buffer, stored values, evaluation context, etc
+	// todo: command buffer, evaluation context, etc
 
 	static Player FromSettings(const Player_Settings & settings, PlayerID id, Point starting_location);
 
-	void RemoveUnits(Set<UnitID> unit_ids);
+	void AddToCommandGroup(Number group, UnitID unit);
+	void SetCommandGroup(Number group, Unit_Group units);
+	// call after a global value is set so its units are indexed
+	void IndexValue(ValueName name, const std::vector<Command::Variant> & value);
+	// call with the old value before a global value is overwritten
+	void UnindexValue(ValueName name, const std::vector<Command::Variant> & value);
+
+	// removes every reference to the units in one pass
+	// units must be sorted and unique
+	void RemoveUnits(const std::vector<UnitID> & unit_ids);
 
 	ErrorOr<Command::ElementToken> GetTokenForName(Command::ElementName name);
 
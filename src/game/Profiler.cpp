@@ -0,0 +1,88 @@
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Brushlink
+{
+
+const char * GetName(Profile_Phase phase)
+{
+	switch (phase)
+	{
+	case Profile_Phase::Tick:
+		return "Tick";
+	case Profile_Phase::ProcessPlayerInput:
+		return "ProcessPlayerInput";
+	case Profile_Phase::RunPlayerCoroutines:
+		return "RunPlayerCoroutines";
+	case Profile_Phase::AllUnitsTakeAction:
+		return "AllUnitsTakeAction";
+	case Profile_Phase::EvaluateCommands:
+		return "EvaluateCommands";
+	case Profile_Phase::ResolveIntents:
+		return "ResolveIntents";
+	case Profile_Phase::EnergyTick:
+		return "EnergyTick";
+	case Profile_Phase::RemoveDeadUnits:
+		return "RemoveDeadUnits";
+	case Profile_Phase::RecordStateHash:
+		return "RecordStateHash";
+	case Profile_Phase::Render:
+		return "Render";
+	}
+	return "Unknown";
+}
+
+Profile_Stats Profile_Ring::Compute() const
+{
+	Profile_Stats stats;
+	stats.total_samples = written.load(std::memory_order_relaxed);
+	stats.total_us = total_nanoseconds.load(std::memory_order_relaxed) / 1000.0;
+	uint64_t count = std::min<uint64_t>(stats.total_samples, capacity);
+	if (count == 0)
+	{
+		return stats;
+	}
+	std::vector<uint32_t> samples(count);
+	for (uint64_t i = 0; i < count; i++)
+	{
+		samples[i] = nanoseconds[i].load(std::memory_order_relaxed);
+	}
+	uint64_t total = 0;
+	for (auto sample : samples)
+	{
+		total += sample;
+	}
+	auto [min, max] = std::minmax_element(samples.begin(), samples.end());
+	stats.min_us = *min / 1000.0;
+	stats.max_us = *max / 1000.0;
+	// reorders samples, so after min and max are read
+	std::size_t p99_index = (count * 99) / 100;
+	std::nth_element(samples.begin(), samples.begin() + p99_index, samples.end());
+
+	stats.samples = count;
+	stats.mean_us = (static_cast<double>(total) / count) / 1000.0;
+	stats.p99_us = samples[p99_index] / 1000.0;
+	return stats;
+}
+
+void Profiler::Dump(FILE * file) const
+{
+	fprintf(file, "%-20s %8s %10s %10s %10s %10s\n",
+		"phase (us)", "samples", "min", "mean", "p99", "max");
+	for (int i = 0; i < profile_phase_count; i++)
+	{
+		Profile_Stats stats = phases[i].Compute();
+		fprintf(file, "%-20s %8d %10.1f %10.1f %10.1f %10.1f\n",
+			GetName(static_cast<Profile_Phase>(i)),
+			stats.samples,
+			stats.min_us,
+			stats.mean_us,
+			stats.p99_us,
+			stats.max_us);
+	}
+}
+
+} // namespace Brushlink
@@ -0,0 +1,121 @@
+#pragma once
+#ifndef BRUSHLINK_PROFILER_H
+#define BRUSHLINK_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+struct Tigr;
+
+namespace Brushlink
+{
+
+enum class Profile_Phase
+{
+	Tick,
+	ProcessPlayerInput,
+	RunPlayerCoroutines,
+	AllUnitsTakeAction,
+	EvaluateCommands,
+	ResolveIntents,
+	EnergyTick,
+	RemoveDeadUnits,
+	RecordStateHash,
+	Render
+};
+
+constexpr int profile_phase_count = static_cast<int>(Profile_Phase::Render) + 1;
+
+const char * GetName(Profile_Phase phase);
+
+struct Profile_Stats
+{
+	int samples = 0;
+	double min_us = 0.0;
+	double mean_us = 0.0;
+	double p99_us = 0.0;
+	double max_us = 0.0;
+	// over every sample ever added, not only the ones still in the ring
+	uint64_t total_samples = 0;
+	double total_us = 0.0;
+};
+
+// the most recent durations of one phase
+// writers claim a slot with one atomic add and never wait, so a phase
+// can be timed from worker threads; readers may see a slot mid update,
+// which only ever skews one sample
+struct Profile_Ring
+{
+	static constexpr int capacity_bits = 8;
+	static constexpr int capacity = 1 << capacity_bits;
+
+	std::array<std::atomic<uint32_t>, capacity> nanoseconds{};
+	std::atomic<uint64_t> written{0};
+	std::atomic<uint64_t> total_nanoseconds{0};
+
+	inline void Add(uint32_t duration)
+	{
+		uint64_t index = written.fetch_add(1, std::memory_order_relaxed);
+		nanoseconds[index & (capacity - 1)].store(duration, std::memory_order_relaxed);
+		total_nanoseconds.fetch_add(duration, std::memory_order_relaxed);
+	}
+
+	Profile_Stats Compute() const;
+};
+
+struct Profiler
+{
+	bool enabled = true;
+	bool show_overlay = false;
+	std::array<Profile_Ring, profile_phase_count> phases;
+
+	inline void Add(Profile_Phase phase, std::chrono::nanoseconds duration)
+	{
+		uint64_t count = duration.count();
+		phases[static_cast<int>(phase)].Add(count > UINT32_MAX ? UINT32_MAX : count);
+	}
+
+	inline Profile_Stats Compute(Profile_Phase phase) const
+	{
+		return phases[static_cast<int>(phase)].Compute();
+	}
+
+	void Dump(FILE * file) const;
+	void DrawOverlay(Tigr * screen, int x, int y) const;
+};
+
+// times the enclosing scope into one phase, does nothing if profiling is off
+struct Scoped_Timer
+{
+	Profiler * profiler;
+	Profile_Phase phase;
+	std::chrono::steady_clock::time_point start;
+
+	Scoped_Timer(Profiler & profiler, Profile_Phase phase)
+		: profiler(profiler.enabled ? &profiler : nullptr)
+		, phase(phase)
+	{
+		if (this->profiler != nullptr)
+		{
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	~Scoped_Timer()
+	{
+		if (profiler != nullptr)
+		{
+			profiler->Add(phase, std::chrono::steady_clock::now() - start);
+		}
+	}
+
+	Scoped_Timer(const Scoped_Timer &) = delete;
+	Scoped_Timer & operator=(const Scoped_Timer &) = delete;
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_PROFILER_H
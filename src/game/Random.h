@@ -0,0 +1,103 @@
+#pragma once
+#ifndef BRUSHLINK_RANDOM_H
+#define BRUSHLINK_RANDOM_H
+
+#include <array>
+#include <cstdint>
+
+#include "Game_Basic_Types.h"
+#include "Game_Time.h"
+
+namespace Brushlink
+{
+
+// Philox 4x32-10 counter based generator, Salmon et al. "Parallel Random Numbers: As Easy as 1, 2, 3"
+// the output is a pure function of the key and the counter, there is no state to advance
+// so a draw can be reproduced from the seed, tick and unit alone
+// regardless of which thread asks or in what order
+struct Philox
+{
+	using Block = std::array<uint32_t, 4>;
+	using Key = std::array<uint32_t, 2>;
+
+	static inline Block Generate(Block counter, Key key)
+	{
+		for (int round = 0; round < 10; round++)
+		{
+			uint64_t product0 = uint64_t{0xD2511F53} * counter[0];
+			uint64_t product1 = uint64_t{0xCD9E8D57} * counter[2];
+			counter = {
+				static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+				static_cast<uint32_t>(product1),
+				static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+				static_cast<uint32_t>(product0)
+			};
+			key[0] += 0x9E3779B9;
+			key[1] += 0xBB67AE85;
+		}
+		return counter;
+	}
+};
+
+// keeps streams for different uses apart even for the same unit and tick
+enum class Random_Purpose
+{
+	Spawn_Type,
+};
+
+// the draws for one purpose, tick and unit
+// cheap to make, so take a new one where it's needed instead of sharing it
+struct Random_Stream
+{
+	Philox::Key key;
+	Philox::Block counter; // draw block, tick, unit, purpose
+	Philox::Block block{};
+	int used = 4; // words of block already handed out
+
+	inline uint32_t Next()
+	{
+		if (used == 4)
+		{
+			block = Philox::Generate(counter, key);
+			counter[0]++;
+			used = 0;
+		}
+		return block[used++];
+	}
+
+	// inclusive on both ends
+	inline int Range(int min, int max)
+	{
+		uint64_t span = static_cast<uint64_t>(max - min) + 1;
+		return min + static_cast<int>((Next() * span) >> 32);
+	}
+
+	// [0, 1)
+	inline float Unit()
+	{
+		return static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f);
+	}
+};
+
+// owned by the game, the seed is the only state
+struct Random_Service
+{
+	uint64_t seed = 0;
+
+	inline Random_Stream Stream(Random_Purpose purpose, Ticks tick, UnitID unit = no_unit) const
+	{
+		return Random_Stream{
+			{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+			{
+				0,
+				static_cast<uint32_t>(tick.value),
+				static_cast<uint32_t>(unit.value),
+				static_cast<uint32_t>(purpose)
+			}
+		};
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_RANDOM_H
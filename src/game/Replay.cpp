@@ -0,0 +1,277 @@
+
+#include "Replay.h"
+
+#include <cstdio>
+
+namespace Brushlink
+{
+
+void Replay::WriteRules(Byte_Writer & writer, const Ruleset & rules)
+{
+	writer.PutVarint(rules.speed.value);
+	writer.PutVarint(unit_type_count);
+	writer.PutVarint(action_type_count);
+	for (auto & unit : rules.unit_types)
+	{
+		writer.PutVarint(static_cast<int>(unit.type));
+		writer.PutSigned(unit.starting_energy.value);
+		writer.PutSigned(unit.max_energy.value);
+		writer.PutSigned(unit.recharge_amount.value);
+		writer.PutVarint(unit.recharge_period.value);
+		writer.PutFloat(unit.vision_radius);
+		for (auto & action : unit.actions)
+		{
+			writer.PutByte(action.available);
+			writer.PutSigned(action.cost.value);
+			writer.PutSigned(action.magnitude.value);
+			writer.PutVarint(action.cooldown.value);
+			writer.PutVarint(action.duration.value);
+		}
+		for (auto & modifier : unit.targeted_modifiers)
+		{
+			writer.PutSigned(modifier.value);
+		}
+	}
+	writer.PutVarint(rules.crowded_threshold.value);
+	writer.PutSigned(rules.crowded_decay_amount.value);
+	writer.PutVarint(rules.crowded_decay_period.value);
+}
+
+Ruleset Replay::ReadRules(Byte_Reader & reader)
+{
+	Ruleset rules;
+	rules.speed.value = reader.GetVarint();
+	if (reader.GetVarint() != unit_type_count
+		|| reader.GetVarint() != action_type_count)
+	{
+		// recorded with a different set of units or actions
+		reader.failed = true;
+		return rules;
+	}
+	for (auto & unit : rules.unit_types)
+	{
+		unit.type = static_cast<Unit_Type>(reader.GetVarint());
+		unit.starting_energy.value = reader.GetSigned();
+		unit.max_energy.value = reader.GetSigned();
+		unit.recharge_amount.value = reader.GetSigned();
+		unit.recharge_period.value = reader.GetVarint();
+		unit.vision_radius = reader.GetFloat();
+		for (auto & action : unit.actions)
+		{
+			action.available = reader.GetByte() != 0;
+			action.cost.value = reader.GetSigned();
+			action.magnitude.value = reader.GetSigned();
+			action.cooldown.value = reader.GetVarint();
+			action.duration.value = reader.GetVarint();
+		}
+		for (auto & modifier : unit.targeted_modifiers)
+		{
+			modifier.value = reader.GetSigned();
+		}
+	}
+	rules.crowded_threshold.value = reader.GetVarint();
+	rules.crowded_decay_amount.value = reader.GetSigned();
+	rules.crowded_decay_period.value = reader.GetVarint();
+	return rules;
+}
+
+void Replay::WriteCommand(Byte_Writer & writer, Ticks tick_base, Ticks tick, const Issued_Command & command)
+{
+	writer.PutVarint(tick.value - tick_base.value);
+	writer.PutVarint(command.player.value);
+	writer.PutVarint(static_cast<int>(command.type));
+	writer.PutVarint(command.actors.size());
+	int previous = 0;
+	for (auto actor : command.actors)
+	{
+		writer.PutVarint(actor.value - previous);
+		previous = actor.value;
+	}
+	writer.PutSigned(command.location.x);
+	writer.PutSigned(command.location.y);
+}
+
+Issued_Command Replay::ReadCommand(Byte_Reader & reader, Ticks tick_base, Ticks & tick)
+{
+	tick.value = tick_base.value + reader.GetVarint();
+	Issued_Command command;
+	command.player.value = reader.GetVarint();
+	command.type = static_cast<Issued_Command_Type>(reader.GetVarint());
+	std::size_t actor_count = reader.GetVarint();
+	if (actor_count > reader.size - reader.offset)
+	{
+		// every actor takes at least a byte
+		reader.failed = true;
+		return command;
+	}
+	int previous = 0;
+	command.actors.reserve(actor_count);
+	for (std::size_t i = 0; i < actor_count; i++)
+	{
+		previous += reader.GetVarint();
+		command.actors.push_back(UnitID{previous});
+	}
+	command.location.x = reader.GetSigned();
+	command.location.y = reader.GetSigned();
+	return command;
+}
+
+ErrorOr<Success> Replay::Save(const std::string & file_name) const
+{
+	Byte_Writer writer;
+	writer.PutFixed32(magic);
+	writer.PutVarint(version);
+	writer.PutFixed64(seed);
+	WriteRules(writer, rules);
+	writer.PutVarint(width);
+	writer.PutVarint(height);
+	writer.PutVarint(starting_locations.size());
+	for (auto & location : starting_locations)
+	{
+		writer.PutSigned(location.x);
+		writer.PutSigned(location.y);
+	}
+	writer.PutVarint(starting_units.size());
+	for (auto & [offset, type] : starting_units)
+	{
+		writer.PutSigned(offset.x);
+		writer.PutSigned(offset.y);
+		writer.PutVarint(static_cast<int>(type));
+	}
+	writer.PutVarint(players.size());
+	for (auto & [id, type] : players)
+	{
+		writer.PutVarint(id.value);
+		writer.PutVarint(static_cast<int>(type));
+	}
+	writer.PutVarint(length.value);
+	writer.PutVarint(keyframes.size());
+	for (auto & keyframe : keyframes)
+	{
+		writer.PutVarint(keyframe.tick.value);
+		writer.PutFixed64(keyframe.state_hash);
+		writer.PutVarint(keyframe.command_offset);
+		writer.PutVarint(keyframe.command_tick_base.value);
+		writer.PutBytes(keyframe.state.data(), keyframe.state.size());
+	}
+	writer.PutBytes(commands.data(), commands.size());
+
+	FILE * file = fopen(file_name.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return Error("Couldn't open replay file for writing");
+	}
+	std::size_t written = fwrite(writer.bytes.data(), 1, writer.bytes.size(), file);
+	fclose(file);
+	if (written != writer.bytes.size())
+	{
+		return Error("Couldn't write the whole replay file");
+	}
+	return Success();
+}
+
+ErrorOr<Replay> Replay::Load(const std::string & file_name)
+{
+	FILE * file = fopen(file_name.c_str(), "rb");
+	if (file == nullptr)
+	{
+		return Error("Couldn't open replay file for reading");
+	}
+	std::vector<uint8_t> bytes;
+	uint8_t buffer[1 << 16];
+	std::size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		bytes.insert(bytes.end(), buffer, buffer + read);
+	}
+	fclose(file);
+
+	Byte_Reader reader{bytes.data(), bytes.size()};
+	if (reader.GetFixed32() != magic)
+	{
+		return Error("Not a replay file");
+	}
+	if (reader.GetVarint() != version)
+	{
+		return Error("Replay was recorded with an unsupported version");
+	}
+	Replay replay;
+	replay.seed = reader.GetFixed64();
+	replay.rules = ReadRules(reader);
+	replay.width = reader.GetVarint();
+	replay.height = reader.GetVarint();
+	std::size_t location_count = reader.GetVarint();
+	for (std::size_t i = 0; i < location_count && !reader.failed; i++)
+	{
+		Point location;
+		location.x = reader.GetSigned();
+		location.y = reader.GetSigned();
+		replay.starting_locations.push_back(location);
+	}
+	std::size_t unit_count = reader.GetVarint();
+	for (std::size_t i = 0; i < unit_count && !reader.failed; i++)
+	{
+		Point offset;
+		offset.x = reader.GetSigned();
+		offset.y = reader.GetSigned();
+		Unit_Type type = static_cast<Unit_Type>(reader.GetVarint());
+		replay.starting_units.emplace_back(offset, type);
+	}
+	std::size_t player_count = reader.GetVarint();
+	for (std::size_t i = 0; i < player_count && !reader.failed; i++)
+	{
+		PlayerID id{static_cast<int>(reader.GetVarint())};
+		Player_Type type = static_cast<Player_Type>(reader.GetVarint());
+		replay.players.emplace_back(id, type);
+	}
+	replay.length.value = reader.GetVarint();
+	std::size_t keyframe_count = reader.GetVarint();
+	for (std::size_t i = 0; i < keyframe_count && !reader.failed; i++)
+	{
+		Replay_Keyframe keyframe;
+		keyframe.tick.value = reader.GetVarint();
+		keyframe.state_hash = reader.GetFixed64();
+		keyframe.command_offset = reader.GetVarint();
+		keyframe.command_tick_base.value = reader.GetVarint();
+		std::size_t state_bytes = 0;
+		const uint8_t * state = reader.GetBytes(state_bytes);
+		// copied out so it's aligned for Game::LoadState
+		keyframe.state.assign(state, state + state_bytes);
+		replay.keyframes.push_back(std::move(keyframe));
+	}
+	std::size_t command_bytes = 0;
+	const uint8_t * commands = reader.GetBytes(command_bytes);
+	if (reader.failed)
+	{
+		return Error("Replay file is truncated or corrupt");
+	}
+	replay.commands.assign(commands, commands + command_bytes);
+	return replay;
+}
+
+void Replay_Recorder::Record(Ticks tick, const Issued_Command & command)
+{
+	Byte_Writer writer;
+	Replay::WriteCommand(writer, last_command_tick, tick, command);
+	replay.commands.insert(replay.commands.end(), writer.bytes.begin(), writer.bytes.end());
+	last_command_tick = tick;
+}
+
+Replay_Keyframe * Replay_Recorder::EndTick(Ticks tick, const State_Hash & hash)
+{
+	replay.length = tick;
+	if (keyframe_interval <= 0 || tick.value % keyframe_interval != 0)
+	{
+		return nullptr;
+	}
+	replay.keyframes.push_back({
+		tick,
+		hash.Combined(),
+		replay.commands.size(),
+		last_command_tick,
+		{}
+	});
+	return &replay.keyframes.back();
+}
+
+} // namespace Brushlink
@@ -0,0 +1,83 @@
+#pragma once
+#ifndef BRUSHLINK_REPLAY_H
+#define BRUSHLINK_REPLAY_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ErrorOr.hpp"
+
+#include "Game_Basic_Types.h"
+#include "Game_Time.h"
+#include "Location.h"
+#include "Ruleset.h"
+#include "Command.h"
+#include "Player.h"
+#include "State_Hash.h"
+#include "Byte_Stream.h"
+
+namespace Brushlink
+{
+
+using namespace Farb;
+
+// the game state at a tick, and where the command stream was at the end of it
+// seeking only has to simulate from the nearest keyframe, see Replay_Player
+// the state is a save file without the state loading rebuilds, see Game::SaveState
+struct Replay_Keyframe
+{
+	Ticks tick;
+	uint64_t state_hash = 0;
+	std::size_t command_offset = 0;
+	Ticks command_tick_base; // tick of the last command before command_offset
+	std::vector<uint8_t> state;
+};
+
+// everything needed to play a game back through the simulation:
+// the seed, the compiled rules, the starting setup and every issued command
+// commands are varint encoded, ticks as the delta from the previous command
+// and actors as deltas from the previous actor
+struct Replay
+{
+	static constexpr uint32_t magic = 0x50524c42; // "BLRP"
+	static constexpr uint32_t version = 2;
+	// 50 seconds at the default speed
+	static constexpr int default_keyframe_interval = 600;
+
+	uint64_t seed = 0;
+	Ruleset rules;
+	int width = 0;
+	int height = 0;
+	std::vector<Point> starting_locations;
+	std::vector<std::pair<Point, Unit_Type> > starting_units;
+	std::vector<std::pair<PlayerID, Player_Type> > players;
+	Ticks length {0};
+	std::vector<Replay_Keyframe> keyframes;
+	std::vector<uint8_t> commands;
+
+	ErrorOr<Success> Save(const std::string & file_name) const;
+	static ErrorOr<Replay> Load(const std::string & file_name);
+
+	// helpers
+	static void WriteRules(Byte_Writer & writer, const Ruleset & rules);
+	static Ruleset ReadRules(Byte_Reader & reader);
+	static void WriteCommand(Byte_Writer & writer, Ticks tick_base, Ticks tick, const Issued_Command & command);
+	static Issued_Command ReadCommand(Byte_Reader & reader, Ticks tick_base, Ticks & tick);
+};
+
+// appends to a replay as the game runs, see Game::RecordReplay
+struct Replay_Recorder
+{
+	Replay replay;
+	int keyframe_interval = Replay::default_keyframe_interval;
+	Ticks last_command_tick {0};
+
+	void Record(Ticks tick, const Issued_Command & command);
+	// the keyframe added at this tick for the game to fill in the state of, or nullptr
+	Replay_Keyframe * EndTick(Ticks tick, const State_Hash & hash);
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_REPLAY_H
@@ -0,0 +1,172 @@
+
+#include "Replay_Player.h"
+
+namespace Brushlink
+{
+
+Replay_Player::Replay_Player(std::shared_ptr<const Replay> replay, std::function<void(Game &)> setup)
+	: replay(replay)
+	, rules(std::make_shared<const Ruleset>(replay->rules))
+	, setup(std::move(setup))
+	, keyframe_games(replay->keyframes.size())
+{
+	Restart();
+}
+
+GameSettings Replay_Player::MakeSettings() const
+{
+	GameSettings settings = GameSettings::default_settings;
+	settings.seed = replay->seed;
+	settings.world_settings.width = replay->width;
+	settings.world_settings.height = replay->height;
+	settings.world_settings.starting_locations = replay->starting_locations;
+	settings.starting_units.clear();
+	for (auto & [offset, type] : replay->starting_units)
+	{
+		settings.starting_units[offset] = type;
+	}
+	settings.player_settings.clear();
+	for (auto & [id, type] : replay->players)
+	{
+		settings.player_settings[id] = Player_Settings{type};
+	}
+	return settings;
+}
+
+void Replay_Player::Restart()
+{
+	game.reset(new Game{rules, MakeSettings()});
+	game->Initialize();
+	if (setup)
+	{
+		setup(*game);
+	}
+	commands = Byte_Reader{replay->commands.data(), replay->commands.size()};
+	command_tick_base = Ticks{0};
+	next_keyframe = 0;
+}
+
+ErrorOr<Success> Replay_Player::Step()
+{
+	Ticks next_tick{game->tick.value + 1};
+	while (!commands.AtEnd())
+	{
+		std::size_t start = commands.offset;
+		Ticks command_tick;
+		Issued_Command command = Replay::ReadCommand(commands, command_tick_base, command_tick);
+		if (commands.failed)
+		{
+			return Error("Replay command stream is corrupt");
+		}
+		if (command_tick > next_tick)
+		{
+			// belongs to a later tick
+			commands.offset = start;
+			break;
+		}
+		command_tick_base = command_tick;
+		game->Issue(std::move(command));
+	}
+	game->Tick();
+
+	if (next_keyframe < replay->keyframes.size()
+		&& replay->keyframes[next_keyframe].tick == game->tick)
+	{
+		if (game->GetStateHash().Combined() != replay->keyframes[next_keyframe].state_hash)
+		{
+			return Error("Replay desynced at tick " + std::to_string(game->tick.value));
+		}
+		if (!keyframe_games[next_keyframe])
+		{
+			keyframe_games[next_keyframe] = game->Snapshot();
+		}
+		next_keyframe++;
+	}
+	return Success();
+}
+
+ErrorOr<Success> Replay_Player::Seek(Ticks target)
+{
+	if (target > replay->length)
+	{
+		target = replay->length;
+	}
+	// the latest keyframe at or before the target that has a state to start from
+	int nearest = -1;
+	for (int i = 0; i < static_cast<int>(keyframe_games.size()); i++)
+	{
+		if (replay->keyframes[i].tick > target)
+		{
+			break;
+		}
+		if (keyframe_games[i] || !replay->keyframes[i].state.empty())
+		{
+			nearest = i;
+		}
+	}
+	bool behind_target = game->tick <= target;
+	if (nearest >= 0
+		&& (!behind_target || replay->keyframes[nearest].tick > game->tick))
+	{
+		if (!keyframe_games[nearest])
+		{
+			auto loaded = LoadKeyframe(nearest);
+			if (loaded.IsError())
+			{
+				return loaded.GetError();
+			}
+		}
+		const Replay_Keyframe & keyframe = replay->keyframes[nearest];
+		game = keyframe_games[nearest]->Snapshot();
+		game->workers.SetThreadCount(Worker_Pool::DefaultThreadCount());
+		commands.offset = keyframe.command_offset;
+		command_tick_base = keyframe.command_tick_base;
+		next_keyframe = nearest + 1;
+	}
+	else if (!behind_target)
+	{
+		Restart();
+	}
+	while (game->tick < target)
+	{
+		auto result = Step();
+		if (result.IsError())
+		{
+			return result.GetError();
+		}
+	}
+	return Success();
+}
+
+ErrorOr<Success> Replay_Player::LoadKeyframe(int index)
+{
+	const Replay_Keyframe & keyframe = replay->keyframes[index];
+	auto loaded = Game::LoadState(keyframe.state.data(), keyframe.state.size(), MakeSettings());
+	if (loaded.IsError())
+	{
+		return loaded.GetError();
+	}
+	std::unique_ptr<Game> & keyframe_game = loaded.GetValue();
+	if (keyframe_game->tick != keyframe.tick
+		|| keyframe_game->GetStateHash().Combined() != keyframe.state_hash)
+	{
+		return Error("Replay keyframe at tick " + std::to_string(keyframe.tick.value) + " doesn't match its hash");
+	}
+	keyframe_games[index] = std::move(keyframe_game);
+	return Success();
+}
+
+ErrorOr<Success> Replay_Player::BuildKeyframes()
+{
+	while (!IsOver())
+	{
+		auto result = Step();
+		if (result.IsError())
+		{
+			return result.GetError();
+		}
+	}
+	return Success();
+}
+
+} // namespace Brushlink
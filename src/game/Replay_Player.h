@@ -0,0 +1,54 @@
+#pragma once
+#ifndef BRUSHLINK_REPLAY_PLAYER_H
+#define BRUSHLINK_REPLAY_PLAYER_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Game.h"
+#include "Replay.h"
+
+namespace Brushlink
+{
+
+// plays a replay back through a headless game as fast as it will tick
+// seeking loads the nearest keyframe's saved state and only simulates from there
+// a snapshot is kept at every keyframe once it's loaded or reached
+// so it isn't loaded again, and replays recorded without keyframe state
+// can still seek from the keyframes playback has already reached
+struct Replay_Player
+{
+	std::shared_ptr<const Replay> replay;
+	std::shared_ptr<const Ruleset> rules;
+	// runs after a new game is initialized, e.g. to give scripted players their commands
+	std::function<void(Game &)> setup;
+	std::unique_ptr<Game> game;
+	Byte_Reader commands;
+	Ticks command_tick_base {0};
+	std::size_t next_keyframe = 0;
+	// same index as replay->keyframes, nullptr until loaded or reached
+	std::vector<std::unique_ptr<Game> > keyframe_games;
+
+	Replay_Player(std::shared_ptr<const Replay> replay, std::function<void(Game &)> setup = nullptr);
+
+	GameSettings MakeSettings() const;
+	void Restart();
+
+	inline bool IsOver() const
+	{
+		return game->tick >= replay->length;
+	}
+
+	// errors if the state hash doesn't match the recording at a keyframe
+	ErrorOr<Success> Step();
+	ErrorOr<Success> Seek(Ticks target);
+	// errors if the state is corrupt or doesn't match the keyframe's hash
+	ErrorOr<Success> LoadKeyframe(int index);
+	// plays to the end once, checking every keyframe's hash along the way
+	ErrorOr<Success> BuildKeyframes();
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_REPLAY_PLAYER_H
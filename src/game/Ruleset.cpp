@@ -0,0 +1,58 @@
+
+#include "Ruleset.h"
+#include "Game.h"
+
+#include "IntExtensions.hpp"
+
+namespace Brushlink
+{
+
+std::shared_ptr<const Ruleset> Ruleset::Compile(const GameSettings & settings)
+{
+	auto rules = std::make_shared<Ruleset>();
+	rules->speed = settings.speed;
+	rules->crowded_threshold = settings.crowded_threshold;
+	rules->crowded_decay_amount = settings.crowded_decay.first;
+	rules->crowded_decay_period = SecondsToTicks(settings.crowded_decay.second, settings.speed);
+
+	for (int i = 0; i < unit_type_count; i++)
+	{
+		rules->unit_types[i].type = static_cast<Unit_Type>(i);
+	}
+
+	for (auto & [unit_type, unit_settings] : settings.unit_types)
+	{
+		Unit_Rules & unit = rules->unit_types[static_cast<int>(unit_type)];
+		unit.starting_energy = unit_settings.starting_energy;
+		unit.max_energy = unit_settings.max_energy;
+		unit.recharge_amount = unit_settings.recharge_rate.first;
+		unit.recharge_period = SecondsToTicks(unit_settings.recharge_rate.second, settings.speed);
+		if (unit.recharge_period.value < 1)
+		{
+			// recharging faster than once per tick isn't representable
+			unit.recharge_period.value = 1;
+		}
+		unit.vision_radius = unit_settings.vision_radius;
+		for (auto & [action_type, action_settings] : unit_settings.actions)
+		{
+			Action_Rules & action = unit.actions[static_cast<int>(action_type)];
+			action.available = true;
+			action.cost = action_settings.cost;
+			action.magnitude = action_settings.magnitude;
+			action.cooldown = SecondsToTicks(action_settings.cooldown, settings.speed);
+			action.duration = SecondsToTicks(action_settings.duration, settings.speed);
+		}
+		for (auto & [action_type, modifier] : unit_settings.targeted_modifiers)
+		{
+			unit.targeted_modifiers[static_cast<int>(action_type)] = modifier.amount;
+		}
+	}
+	return rules;
+}
+
+Ticks Ruleset::SecondsToTicks(Seconds s, Ticks speed)
+{
+	return Ticks{ Round(s.value * speed.value) };
+}
+
+} // namespace Brushlink
@@ -0,0 +1,81 @@
+#pragma once
+#ifndef BRUSHLINK_RULESET_H
+#define BRUSHLINK_RULESET_H
+
+#include <array>
+#include <memory>
+
+#include "Resources.h"
+#include "Game_Time.h"
+#include "Game_Basic_Types.h"
+#include "Action.h"
+#include "Basic_Types.h"
+
+namespace Brushlink
+{
+
+struct GameSettings;
+
+// GameSettings compiled for the simulation
+// every table is indexed by enum and every duration is already in ticks
+// so lookups while ticking are array reads instead of map finds and float math
+
+struct Action_Rules
+{
+	bool available = false; // false if the unit type can't take this action
+	Energy cost {0};
+	Energy magnitude {0};
+	Ticks cooldown {0};
+	Ticks duration {0};
+};
+
+struct Unit_Rules
+{
+	Unit_Type type;
+	Energy starting_energy {0};
+	Energy max_energy {0};
+	Energy recharge_amount {0};
+	Ticks recharge_period {1};
+	float vision_radius = 0.0;
+	std::array<Action_Rules, action_type_count> actions{};
+	// added to the magnitude of actions targeting this unit type, 0 if none
+	std::array<Energy, action_type_count> targeted_modifiers{};
+
+	inline const Action_Rules & Action(Action_Type action) const
+	{
+		return actions[static_cast<int>(action)];
+	}
+
+	inline Energy TargetedModifier(Action_Type action) const
+	{
+		return targeted_modifiers[static_cast<int>(action)];
+	}
+};
+
+// immutable once compiled, so any number of games can share one
+struct Ruleset
+{
+	Ticks speed {12}; // per second
+	std::array<Unit_Rules, unit_type_count> unit_types{};
+	Number crowded_threshold {6};
+	Energy crowded_decay_amount {1};
+	Ticks crowded_decay_period {12};
+
+	static std::shared_ptr<const Ruleset> Compile(const GameSettings & settings);
+
+	static Ticks SecondsToTicks(Seconds s, Ticks speed);
+
+	inline Ticks SecondsToTicks(Seconds s) const
+	{
+		return SecondsToTicks(s, speed);
+	}
+
+	inline const Unit_Rules & Unit(Unit_Type type) const
+	{
+		return unit_types[static_cast<int>(type)];
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_RULESET_H
@@ -0,0 +1,1066 @@
+#include "Save_File.h"
+#include "Game.h"
+#include "Byte_Stream.h"
+
+#include <cstdio>
+#include <cstring>
+#include <queue>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Command;
+
+namespace Brushlink
+{
+
+// helpers
+
+static void WriteValue(Byte_Writer & writer, const Success &) { }
+static void ReadValue(Byte_Reader & reader, Success &) { }
+
+static void WriteValue(Byte_Writer & writer, const Bool & value) { writer.PutByte(value); }
+static void ReadValue(Byte_Reader & reader, Bool & value) { value = reader.GetByte() != 0; }
+
+static void WriteValue(Byte_Writer & writer, const Number & value) { writer.PutSigned(value.value); }
+static void ReadValue(Byte_Reader & reader, Number & value) { value.value = reader.GetSigned(); }
+
+static void WriteValue(Byte_Writer & writer, const Digit & value) { writer.PutSigned(value.value); }
+static void ReadValue(Byte_Reader & reader, Digit & value) { value.value = reader.GetSigned(); }
+
+static void WriteValue(Byte_Writer & writer, const ValueName & value) { writer.PutString(value.value); }
+static void ReadValue(Byte_Reader & reader, ValueName & value) { value = ValueName{reader.GetString()}; }
+
+static void WriteValue(Byte_Writer & writer, const Letter & value) { writer.PutByte(value.value); }
+static void ReadValue(Byte_Reader & reader, Letter & value) { value.value = reader.GetByte(); }
+
+static void WriteValue(Byte_Writer & writer, const Seconds & value) { writer.PutFloat(value.value); }
+static void ReadValue(Byte_Reader & reader, Seconds & value) { value.value = reader.GetFloat(); }
+
+static void WriteValue(Byte_Writer & writer, const UnitID & value) { writer.PutSigned(value.value); }
+static void ReadValue(Byte_Reader & reader, UnitID & value) { value.value = reader.GetSigned(); }
+
+static void WriteValue(Byte_Writer & writer, const Energy & value) { writer.PutSigned(value.value); }
+static void ReadValue(Byte_Reader & reader, Energy & value) { value.value = reader.GetSigned(); }
+
+template<typename T, std::enable_if_t<std::is_enum_v<T>, int> = 0>
+static void WriteValue(Byte_Writer & writer, const T & value) { writer.PutSigned(static_cast<int>(value)); }
+template<typename T, std::enable_if_t<std::is_enum_v<T>, int> = 0>
+static void ReadValue(Byte_Reader & reader, T & value) { value = static_cast<T>(reader.GetSigned()); }
+
+static void WriteValue(Byte_Writer & writer, const Point & value)
+{
+	writer.PutSigned(value.x);
+	writer.PutSigned(value.y);
+}
+
+static void ReadValue(Byte_Reader & reader, Point & value)
+{
+	value.x = reader.GetSigned();
+	value.y = reader.GetSigned();
+}
+
+static void WriteValue(Byte_Writer & writer, const Direction & value)
+{
+	writer.PutSigned(value.x);
+	writer.PutSigned(value.y);
+}
+
+static void ReadValue(Byte_Reader & reader, Direction & value)
+{
+	value.x = reader.GetSigned();
+	value.y = reader.GetSigned();
+}
+
+static void WriteValue(Byte_Writer & writer, const Action_Step & value)
+{
+	WriteValue(writer, value.type);
+	writer.PutByte(value.location.has_value());
+	if (value.location)
+	{
+		WriteValue(writer, *value.location);
+	}
+	writer.PutByte(value.target.has_value());
+	if (value.target)
+	{
+		WriteValue(writer, *value.target);
+	}
+}
+
+static void ReadValue(Byte_Reader & reader, Action_Step & value)
+{
+	ReadValue(reader, value.type);
+	if (reader.GetByte() != 0)
+	{
+		value.location.emplace();
+		ReadValue(reader, *value.location);
+	}
+	if (reader.GetByte() != 0)
+	{
+		value.target.emplace();
+		ReadValue(reader, *value.target);
+	}
+}
+
+// counts are checked against what's left so a corrupt count can't allocate wildly
+// every element takes at least a byte
+static std::size_t ReadCount(Byte_Reader & reader)
+{
+	std::size_t count = reader.GetVarint();
+	if (count > reader.size - reader.offset)
+	{
+		reader.failed = true;
+		return 0;
+	}
+	return count;
+}
+
+// std::queue only lets derived classes at its container
+template<typename Queue>
+static const typename Queue::container_type & QueueContents(const Queue & queue)
+{
+	struct Access : Queue
+	{
+		static const typename Queue::container_type & Of(const Queue & queue)
+		{
+			return queue.*&Access::c;
+		}
+	};
+	return Access::Of(queue);
+}
+
+template<typename Container>
+static void WriteRange(Byte_Writer & writer, const Container & values)
+{
+	writer.PutVarint(values.size());
+	for (auto & value : values)
+	{
+		WriteValue(writer, value);
+	}
+}
+
+template<typename T, typename F>
+static void ReadRange(Byte_Reader & reader, F && add)
+{
+	std::size_t count = ReadCount(reader);
+	for (std::size_t i = 0; i < count && !reader.failed; i++)
+	{
+		T value{};
+		ReadValue(reader, value);
+		add(std::move(value));
+	}
+}
+
+static void WriteValue(Byte_Writer & writer, const Unit_Group & value) { WriteRange(writer, value.members); }
+static void ReadValue(Byte_Reader & reader, Unit_Group & value)
+{
+	ReadRange<UnitID>(reader, [&](UnitID id) { value.members.insert(id); });
+}
+
+static void WriteValue(Byte_Writer & writer, const Line & value) { WriteRange(writer, value.points); }
+static void ReadValue(Byte_Reader & reader, Line & value)
+{
+	ReadRange<Point>(reader, [&](Point p) { value.points.push_back(p); });
+}
+
+static void WriteValue(Byte_Writer & writer, const Area & value) { WriteRange(writer, value.points); }
+static void ReadValue(Byte_Reader & reader, Area & value)
+{
+	ReadRange<Point>(reader, [&](Point p) { value.points.insert(p); });
+}
+
+static void WriteValue(Byte_Writer & writer, const Variant & value)
+{
+	writer.PutVarint(value.index());
+	std::visit([&](auto & alternative) { WriteValue(writer, alternative); }, value);
+}
+
+template<std::size_t I = 0>
+static Variant ReadAlternative(Byte_Reader & reader, std::size_t index)
+{
+	if constexpr (I < std::variant_size_v<Variant>)
+	{
+		if (index != I)
+		{
+			return ReadAlternative<I + 1>(reader, index);
+		}
+		std::variant_alternative_t<I, Variant> value{};
+		ReadValue(reader, value);
+		return Variant{std::in_place_index<I>, std::move(value)};
+	}
+	else
+	{
+		reader.failed = true;
+		return Variant{};
+	}
+}
+
+static void ReadValue(Byte_Reader & reader, Variant & value)
+{
+	value = ReadAlternative(reader, reader.GetVarint());
+}
+
+static void WriteWheel(Byte_Writer & writer, const Timing_Wheel & wheel)
+{
+	// bucket by bucket so entries come back in the order they were added
+	for (auto & bucket : wheel.wheel)
+	{
+		writer.PutVarint(bucket.size());
+		for (auto & entry : bucket)
+		{
+			writer.PutSigned(entry.tick.value);
+			writer.PutSigned(entry.unit.value);
+		}
+	}
+}
+
+static void ReadWheel(Byte_Reader & reader, Timing_Wheel & wheel)
+{
+	for (auto & bucket : wheel.wheel)
+	{
+		std::size_t count = ReadCount(reader);
+		bucket.resize(count);
+		for (auto & entry : bucket)
+		{
+			entry.tick.value = reader.GetSigned();
+			entry.unit.value = reader.GetSigned();
+		}
+	}
+}
+
+// command types are named once in the state section and referred to by index
+struct Command_Names
+{
+	std::vector<std::string> names;
+	Map<std::string, int> indices;
+	// by index, looked up once when loading rather than once per command
+	std::vector<Action_Command_Loader> loaders;
+
+	void Write(Byte_Writer & writer, const value_ptr<Action_Command> & command)
+	{
+		writer.PutByte(static_cast<bool>(command));
+		if (!command)
+		{
+			return;
+		}
+		std::string name = command->SaveName();
+		auto found = indices.find(name);
+		if (found == indices.end())
+		{
+			found = indices.emplace(name, static_cast<int>(names.size())).first;
+			names.push_back(name);
+		}
+		writer.PutVarint(found->second);
+		command->Save(writer);
+	}
+
+	value_ptr<Action_Command> Read(Byte_Reader & reader) const
+	{
+		if (reader.GetByte() == 0)
+		{
+			return {};
+		}
+		std::size_t index = reader.GetVarint();
+		if (index >= loaders.size())
+		{
+			reader.failed = true;
+			return {};
+		}
+		return value_ptr<Action_Command>{loaders[index](reader)};
+	}
+};
+
+// the sections are laid out as they are added, each on an 8 byte boundary
+struct Save_Builder
+{
+	std::vector<Save_Section> sections;
+	std::vector<uint8_t> body; // offsets are relative to this until Finish
+
+	void Add(Save_Section_Type type, int player, const void * data, std::size_t size)
+	{
+		body.resize((body.size() + 7) & ~std::size_t{7}, 0);
+		sections.push_back({type, player, body.size(), size});
+		const uint8_t * bytes = static_cast<const uint8_t *>(data);
+		body.insert(body.end(), bytes, bytes + size);
+	}
+
+	template<typename T>
+	void Add(Save_Section_Type type, int player, const std::vector<T> & values)
+	{
+		Add(type, player, values.data(), values.size() * sizeof(T));
+	}
+
+	// page after page, so the section is still one flat array
+	template<typename T>
+	void Add(Save_Section_Type type, int player, const Paged_Array<T> & values)
+	{
+		body.resize((body.size() + 7) & ~std::size_t{7}, 0);
+		sections.push_back({type, player, body.size(), values.size * sizeof(T)});
+		for (int start = 0; start < values.size; start += Paged_Array<T>::page_size)
+		{
+			int count = std::min(Paged_Array<T>::page_size, values.size - start);
+			const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&values[start]);
+			body.insert(body.end(), bytes, bytes + count * sizeof(T));
+		}
+	}
+
+	// the whole file
+	std::vector<uint8_t> Finish(uint32_t flags)
+	{
+		std::size_t header_size = sizeof(Save_Header) + sections.size() * sizeof(Save_Section);
+		for (auto & section : sections)
+		{
+			section.offset += header_size;
+		}
+		Save_Header header{
+			Save_Header::magic_value,
+			Save_Header::current_version,
+			static_cast<uint32_t>(sections.size()),
+			flags,
+			header_size + body.size()
+		};
+
+		std::vector<uint8_t> bytes(header_size + body.size());
+		std::memcpy(bytes.data(), &header, sizeof(header));
+		std::memcpy(bytes.data() + sizeof(header), sections.data(), sections.size() * sizeof(Save_Section));
+		std::memcpy(bytes.data() + header_size, body.data(), body.size());
+		return bytes;
+	}
+};
+
+// read only view of a whole file, unmapped when it goes out of scope
+struct Mapped_File
+{
+	const uint8_t * data = nullptr;
+	std::size_t size = 0;
+
+	Mapped_File() = default;
+	Mapped_File(const Mapped_File &) = delete;
+	Mapped_File & operator=(const Mapped_File &) = delete;
+
+	~Mapped_File()
+	{
+		if (data != nullptr)
+		{
+			munmap(const_cast<uint8_t *>(data), size);
+		}
+	}
+
+	ErrorOr<Success> Open(const std::string & file_name)
+	{
+		int descriptor = open(file_name.c_str(), O_RDONLY);
+		if (descriptor < 0)
+		{
+			return Error("Couldn't open save file for reading");
+		}
+		struct stat status;
+		if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+		{
+			close(descriptor);
+			return Error("Couldn't read the size of the save file");
+		}
+		void * mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		// the mapping keeps the file open
+		close(descriptor);
+		if (mapped == MAP_FAILED)
+		{
+			return Error("Couldn't map the save file");
+		}
+		data = static_cast<const uint8_t *>(mapped);
+		size = status.st_size;
+		return Success();
+	}
+};
+
+struct Save_Sections
+{
+	const uint8_t * data;
+	const Save_Section * table;
+	uint32_t count;
+
+	// nullptr if the file has no such section
+	const Save_Section * Find(Save_Section_Type type, int player = -1) const
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (table[i].type == type && table[i].player == player)
+			{
+				return &table[i];
+			}
+		}
+		return nullptr;
+	}
+
+	template<typename T>
+	const T * Array(Save_Section_Type type, int player, std::size_t & length) const
+	{
+		const Save_Section * section = Find(type, player);
+		if (section == nullptr || section->size % sizeof(T) != 0)
+		{
+			length = 0;
+			return nullptr;
+		}
+		length = section->size / sizeof(T);
+		return reinterpret_cast<const T *>(data + section->offset);
+	}
+
+	Byte_Reader Reader(Save_Section_Type type) const
+	{
+		const Save_Section * section = Find(type);
+		if (section == nullptr)
+		{
+			return Byte_Reader{nullptr, 0, 0, true};
+		}
+		return Byte_Reader{data + section->offset, section->size};
+	}
+};
+
+ErrorOr<Success> Game::Save(const std::string & file_name) const
+{
+	std::vector<uint8_t> bytes = SaveState();
+	FILE * file = fopen(file_name.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return Error("Couldn't open save file for writing");
+	}
+	bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	fclose(file);
+	if (!written)
+	{
+		return Error("Couldn't write the whole save file");
+	}
+	return Success();
+}
+
+std::vector<uint8_t> Game::SaveState(bool keyframe) const
+{
+	Save_Builder builder;
+	Command_Names command_names;
+
+	const Unit_Store & store = world.units;
+	std::vector<Saved_Unit> saved_units(store.Count());
+	Byte_Writer orders_writer;
+	for (int slot = 0; slot < store.Count(); slot++)
+	{
+		const Unit & unit = store.hot[slot];
+		Saved_Unit & saved = saved_units[slot];
+		saved = Saved_Unit{};
+		saved.type = static_cast<int32_t>(unit.type->type);
+		saved.id = unit.id.value;
+		saved.player = unit.player.value;
+		saved.x = unit.position.x;
+		saved.y = unit.position.y;
+		saved.energy = unit.energy.value;
+		saved.crowded_duration = unit.crowded_duration.value;
+		saved.crowding = unit.crowding;
+		saved.pending_type = static_cast<int32_t>(unit.pending.type);
+		if (unit.pending.location)
+		{
+			saved.pending_flags |= Saved_Unit::has_location;
+			saved.pending_x = unit.pending.location->x;
+			saved.pending_y = unit.pending.location->y;
+		}
+		if (unit.pending.target)
+		{
+			saved.pending_flags |= Saved_Unit::has_target;
+			saved.pending_target = unit.pending.target->value;
+		}
+		saved.ready_tick = unit.ready_tick.value;
+		saved.wake_tick = unit.wake_tick.value;
+
+		const Unit_Orders & orders = store.orders[slot];
+		for (auto cooldown : orders.cooldown_until)
+		{
+			orders_writer.PutSigned(cooldown.value);
+		}
+		orders_writer.PutVarint(orders.command_queue.size());
+		for (auto & command : QueueContents(orders.command_queue))
+		{
+			command_names.Write(orders_writer, command);
+		}
+		command_names.Write(orders_writer, orders.idle_command);
+	}
+	builder.Add(Save_Section_Type::Units, -1, saved_units);
+	builder.Add(Save_Section_Type::Orders, -1, orders_writer.bytes);
+	builder.Add(Save_Section_Type::Handles, -1, store.handles);
+	builder.Add(Save_Section_Type::Free_Handles, -1,
+		std::vector<int32_t>{store.free_head, store.free_tail});
+
+	std::vector<Saved_Chunk> saved_chunks;
+	for (std::size_t index = 0; index < world.chunks.chunks.size() && !keyframe; index++)
+	{
+		const World_Chunk * chunk = world.chunks.chunks[index].get();
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+		saved_chunks.emplace_back();
+		Saved_Chunk & saved = saved_chunks.back();
+		saved.index = index;
+		saved.reserved = 0;
+		std::copy_n(chunk->occupancy, World_Chunk::tile_count, saved.occupancy);
+		std::copy_n(chunk->terrain, World_Chunk::tile_count, saved.terrain);
+		std::copy_n(chunk->neighbor_count, World_Chunk::tile_count, saved.neighbor_count);
+	}
+	if (!keyframe)
+	{
+		builder.Add(Save_Section_Type::Chunks, -1, saved_chunks);
+		for (auto & [player_id, vision_map] : world.vision)
+		{
+			builder.Add(Save_Section_Type::Vision_Counts, player_id.value, vision_map->counts.tiles);
+			builder.Add(Save_Section_Type::Vision_Visible, player_id.value, vision_map->visible.words);
+			builder.Add(Save_Section_Type::Fog_Mask, player_id.value, vision_map->fog_mask.tiles);
+		}
+	}
+
+	// scripts only read the tick before the one being simulated, see Context::GetUnitsWithEvent
+	// so a keyframe only needs the events of the tick it was taken at
+	// reading that tick still finds the same events, or finds it incomplete the same way
+	uint64_t kept_events = events.Oldest();
+	if (keyframe)
+	{
+		int last_slot = tick.value % Event_Stream::tick_history;
+		kept_events = events.tick_numbers[last_slot] == tick.value
+			? std::max(kept_events, events.tick_starts[last_slot])
+			: events.written;
+	}
+	std::vector<Game_Event> saved_events;
+	saved_events.reserve(events.written - kept_events);
+	for (uint64_t i = kept_events; i < events.written; i++)
+	{
+		saved_events.push_back(events.events[i & events.Mask()]);
+	}
+	builder.Add(Save_Section_Type::Events, -1, saved_events);
+
+	Byte_Writer players_writer;
+	players_writer.PutVarint(players.size());
+	for (auto & [player_id, player] : players)
+	{
+		players_writer.PutSigned(player_id.value);
+		WriteValue(players_writer, player.settings.type);
+		WriteValue(players_writer, player.graphics.pattern);
+		WriteValue(players_writer, player.graphics.palette.type);
+		players_writer.PutVarint(player.graphics.palette.color_count);
+		for (auto & color : player.graphics.palette.colors)
+		{
+			players_writer.PutByte(color.r);
+			players_writer.PutByte(color.g);
+			players_writer.PutByte(color.b);
+			players_writer.PutByte(color.a);
+		}
+		WriteValue(players_writer, player.starting_location);
+		WriteValue(players_writer, player.camera_location);
+		players_writer.PutVarint(player.root_command_context.values.size());
+		for (auto & [name, value] : player.root_command_context.values)
+		{
+			WriteValue(players_writer, name);
+			WriteRange(players_writer, value);
+		}
+		players_writer.PutVarint(player.command_groups.size());
+		for (auto & [group, members] : player.command_groups)
+		{
+			WriteValue(players_writer, group);
+			WriteValue(players_writer, members);
+		}
+		command_names.Write(players_writer, player.idle_command);
+	}
+	builder.Add(Save_Section_Type::Players, -1, players_writer.bytes);
+
+	// written last so it can name every command type the other sections used
+	Byte_Writer writer;
+	writer.PutFixed64(random.seed);
+	writer.PutSigned(tick.value);
+	writer.PutSigned(local_player.value);
+	Replay::WriteRules(writer, *rules);
+	writer.PutVarint(world.settings.width);
+	writer.PutVarint(world.settings.height);
+	WriteRange(writer, world.settings.starting_locations);
+	writer.PutVarint(world.chunks.crowded_threshold);
+	WriteRange(writer, world.chunks.newly_crowded);
+	WriteRange(writer, world.energy_changed);
+	for (auto field : world.hash.fields)
+	{
+		writer.PutFixed64(field);
+	}
+	WriteWheel(writer, schedule.parked);
+	WriteRange(writer, schedule.active);
+	WriteWheel(writer, recharges);
+	WriteRange(writer, crowding);
+	WriteRange(writer, dying);
+	writer.PutVarint(issued.size());
+	for (auto & command : issued)
+	{
+		Replay::WriteCommand(writer, tick, tick, command);
+	}
+	writer.PutVarint(events.events.size);
+	writer.PutVarint(events.written);
+	writer.PutVarint(kept_events);
+	for (int i = 0; i < Event_Stream::tick_history; i++)
+	{
+		writer.PutVarint(events.tick_starts[i]);
+		writer.PutSigned(events.tick_numbers[i]);
+	}
+	writer.PutVarint(keyframe ? 0 : world.vision.size());
+	if (!keyframe)
+	{
+		for (auto & [player_id, vision_map] : world.vision)
+		{
+			writer.PutSigned(player_id.value);
+			writer.PutSigned(vision_map->visible.word_x);
+			writer.PutSigned(vision_map->visible.y);
+			writer.PutVarint(vision_map->visible.word_width);
+			writer.PutVarint(vision_map->visible.height);
+		}
+	}
+	writer.PutVarint(command_names.names.size());
+	for (auto & name : command_names.names)
+	{
+		writer.PutString(name);
+	}
+	builder.Add(Save_Section_Type::State, -1, writer.bytes);
+
+	return builder.Finish(keyframe ? Save_Header::keyframe : 0);
+}
+
+ErrorOr<std::unique_ptr<Game>> Game::Load(const std::string & file_name, const GameSettings & settings)
+{
+	Mapped_File file;
+	auto opened = file.Open(file_name);
+	if (opened.IsError())
+	{
+		return opened.GetError();
+	}
+	return LoadState(file.data, file.size, settings);
+}
+
+// well past what a game's events grow to, so a corrupt capacity can't allocate without bound
+static constexpr uint64_t max_event_capacity = uint64_t{1} << 24;
+
+// keyframes leave out the chunks and vision, both follow from where the units are
+static ErrorOr<Success> RebuildDerivedState(Game & game)
+{
+	World & world = game.world;
+	// setting occupants adds to newly_crowded, which was saved as it was
+	std::vector<Point> newly_crowded = std::move(world.chunks.newly_crowded);
+	world.chunks.newly_crowded.clear();
+	for (const Unit & unit : std::as_const(world.units))
+	{
+		if (world.chunks.GetOccupant(unit.position) != no_unit)
+		{
+			return Error("Save file occupancy doesn't match its units");
+		}
+		world.chunks.SetOccupant(unit.position, unit.id);
+		world.GetVision(unit.player).AddCircle(unit.position, unit.type->vision_radius);
+	}
+	world.chunks.newly_crowded = std::move(newly_crowded);
+	return Success();
+}
+
+ErrorOr<std::unique_ptr<Game>> Game::LoadState(const uint8_t * data, std::size_t size, const GameSettings & settings)
+{
+	// the arrays are read where they are
+	if (reinterpret_cast<uintptr_t>(data) % 8 != 0)
+	{
+		return Error("Save state isn't 8 byte aligned");
+	}
+	if (size < sizeof(Save_Header))
+	{
+		return Error("Not a save file");
+	}
+	Save_Header header;
+	std::memcpy(&header, data, sizeof(header));
+	if (header.magic != Save_Header::magic_value)
+	{
+		return Error("Not a save file");
+	}
+	if (header.version != Save_Header::current_version
+		|| (header.flags & ~Save_Header::keyframe) != 0)
+	{
+		return Error("Save file was written with an unsupported version");
+	}
+	bool keyframe = (header.flags & Save_Header::keyframe) != 0;
+	if (header.file_size != size
+		|| header.section_count > (size - sizeof(Save_Header)) / sizeof(Save_Section))
+	{
+		return Error("Save file is truncated");
+	}
+	Save_Sections sections{
+		data,
+		reinterpret_cast<const Save_Section *>(data + sizeof(Save_Header)),
+		header.section_count
+	};
+	for (uint32_t i = 0; i < sections.count; i++)
+	{
+		const Save_Section & section = sections.table[i];
+		if (section.offset % 8 != 0
+			|| section.offset > size
+			|| section.size > size - section.offset)
+		{
+			return Error("Save file is truncated or corrupt");
+		}
+	}
+
+	Byte_Reader reader = sections.Reader(Save_Section_Type::State);
+	GameSettings loaded_settings = settings;
+	// filled in from the saved players below
+	loaded_settings.player_settings.clear();
+	loaded_settings.seed = reader.GetFixed64();
+	Ticks loaded_tick{static_cast<int>(reader.GetSigned())};
+	PlayerID loaded_local_player{static_cast<int>(reader.GetSigned())};
+	std::shared_ptr<const Ruleset> loaded_rules{new Ruleset{Replay::ReadRules(reader)}};
+	loaded_settings.world_settings.width = reader.GetVarint();
+	loaded_settings.world_settings.height = reader.GetVarint();
+	loaded_settings.world_settings.starting_locations.clear();
+	ReadRange<Point>(reader, [&](Point p) { loaded_settings.world_settings.starting_locations.push_back(p); });
+	if (reader.failed)
+	{
+		return Error("Save file state is truncated or corrupt");
+	}
+
+	std::unique_ptr<Game> game{new Game{loaded_rules, loaded_settings}};
+	World & world = game->world;
+	game->tick = loaded_tick;
+	game->local_player = loaded_local_player;
+	world.chunks.crowded_threshold = reader.GetVarint();
+	ReadRange<Point>(reader, [&](Point p) { world.chunks.newly_crowded.push_back(p); });
+	ReadRange<UnitID>(reader, [&](UnitID id) { world.energy_changed.push_back(id); });
+	for (auto & field : world.hash.fields)
+	{
+		field = reader.GetFixed64();
+	}
+	ReadWheel(reader, game->schedule.parked);
+	ReadRange<UnitID>(reader, [&](UnitID id) { game->schedule.active.push_back(id); });
+	ReadWheel(reader, game->recharges);
+	ReadRange<UnitID>(reader, [&](UnitID id) { game->crowding.push_back(id); });
+	ReadRange<UnitID>(reader, [&](UnitID id) { game->dying.push_back(id); });
+	std::size_t issued_count = ReadCount(reader);
+	for (std::size_t i = 0; i < issued_count && !reader.failed; i++)
+	{
+		Ticks ignored;
+		game->issued.push_back(Replay::ReadCommand(reader, game->tick, ignored));
+	}
+	uint64_t event_capacity = reader.GetVarint();
+	game->events.written = reader.GetVarint();
+	game->events.overwritten = reader.GetVarint();
+	for (int i = 0; i < Event_Stream::tick_history; i++)
+	{
+		game->events.tick_starts[i] = reader.GetVarint();
+		game->events.tick_numbers[i] = reader.GetSigned();
+	}
+	std::size_t vision_count = ReadCount(reader);
+	for (std::size_t i = 0; i < vision_count && !reader.failed; i++)
+	{
+		PlayerID player_id{static_cast<int>(reader.GetSigned())};
+		Vision_Map & vision_map = world.GetVision(player_id);
+		vision_map.visible.word_x = reader.GetSigned();
+		vision_map.visible.y = reader.GetSigned();
+		vision_map.visible.word_width = reader.GetVarint();
+		vision_map.visible.height = reader.GetVarint();
+
+		std::size_t count_length, word_length, fog_length;
+		const uint16_t * counts = sections.Array<uint16_t>(Save_Section_Type::Vision_Counts, player_id.value, count_length);
+		const uint64_t * words = sections.Array<uint64_t>(Save_Section_Type::Vision_Visible, player_id.value, word_length);
+		const uint8_t * fog = sections.Array<uint8_t>(Save_Section_Type::Fog_Mask, player_id.value, fog_length);
+		if (counts == nullptr || fog == nullptr
+			|| count_length != vision_map.counts.tiles.size()
+			|| fog_length != vision_map.fog_mask.tiles.size()
+			|| word_length != static_cast<std::size_t>(vision_map.visible.word_width) * vision_map.visible.height)
+		{
+			return Error("Save file vision doesn't match the world size");
+		}
+		std::copy_n(counts, count_length, vision_map.counts.tiles.begin());
+		std::copy_n(fog, fog_length, vision_map.fog_mask.tiles.begin());
+		vision_map.visible.words.assign(words, words + word_length);
+	}
+	Command_Names command_names;
+	std::size_t name_count = ReadCount(reader);
+	for (std::size_t i = 0; i < name_count && !reader.failed; i++)
+	{
+		std::string name = reader.GetString();
+		Action_Command_Loader loader = FindActionCommandLoader(name);
+		if (loader == nullptr)
+		{
+			return Error("Save file has a " + name + " command, which this build doesn't have");
+		}
+		command_names.loaders.push_back(loader);
+	}
+	if (reader.failed)
+	{
+		return Error("Save file state is truncated or corrupt");
+	}
+
+	reader = sections.Reader(Save_Section_Type::Players);
+	std::size_t player_count = ReadCount(reader);
+	for (std::size_t i = 0; i < player_count && !reader.failed; i++)
+	{
+		PlayerID player_id{static_cast<int>(reader.GetSigned())};
+		Player_Settings player_settings;
+		ReadValue(reader, player_settings.type);
+		game->settings.player_settings[player_id] = player_settings;
+		Player player = Player::FromSettings(player_settings, player_id, Point{});
+		ReadValue(reader, player.graphics.pattern);
+		ReadValue(reader, player.graphics.palette.type);
+		player.graphics.palette.color_count = reader.GetVarint();
+		for (auto & color : player.graphics.palette.colors)
+		{
+			color.r = reader.GetByte();
+			color.g = reader.GetByte();
+			color.b = reader.GetByte();
+			color.a = reader.GetByte();
+		}
+		ReadValue(reader, player.starting_location);
+		ReadValue(reader, player.camera_location);
+		std::size_t value_count = ReadCount(reader);
+		for (std::size_t v = 0; v < value_count && !reader.failed; v++)
+		{
+			ValueName name;
+			ReadValue(reader, name);
+			std::vector<Variant> value;
+			ReadRange<Variant>(reader, [&](Variant element) { value.push_back(std::move(element)); });
+			player.IndexValue(name, value);
+			player.root_command_context.values[name] = std::move(value);
+		}
+		std::size_t group_count = ReadCount(reader);
+		for (std::size_t g = 0; g < group_count && !reader.failed; g++)
+		{
+			Number group;
+			Unit_Group members;
+			ReadValue(reader, group);
+			ReadValue(reader, members);
+			player.SetCommandGroup(group, std::move(members));
+		}
+		player.idle_command = command_names.Read(reader);
+		world.player_graphics[player_id] = player.graphics;
+		game->players[player_id] = std::move(player);
+	}
+	if (reader.failed)
+	{
+		return Error("Save file players are truncated or corrupt");
+	}
+	for (auto & pair : game->players)
+	{
+		pair.second.root_command_context.game = game.get();
+		pair.second.root_command_context.player = &pair.second;
+	}
+
+	// units, the type pointer is the only field that can't be copied as is
+	std::size_t unit_count, handle_count, free_count;
+	const Saved_Unit * saved_units = sections.Array<Saved_Unit>(Save_Section_Type::Units, -1, unit_count);
+	const Unit_Store::Handle * handles = sections.Array<Unit_Store::Handle>(Save_Section_Type::Handles, -1, handle_count);
+	const int32_t * free_handles = sections.Array<int32_t>(Save_Section_Type::Free_Handles, -1, free_count);
+	if (saved_units == nullptr || handles == nullptr || free_handles == nullptr)
+	{
+		return Error("Save file is missing its units");
+	}
+	if (free_count != 2 || handle_count > static_cast<std::size_t>(Unit_Store::index_mask) + 1)
+	{
+		return Error("Save file units are corrupt");
+	}
+	for (std::size_t i = 0; i < handle_count; i++)
+	{
+		if (handles[i].slot >= static_cast<int>(unit_count))
+		{
+			return Error("Save file units are corrupt");
+		}
+	}
+	// the free queue is linked through the handles, it has to end at the tail
+	// and can't be longer than the handles, which also rules out a loop
+	int free_head = free_handles[0];
+	int free_tail = free_handles[1];
+	int last_free = -1;
+	std::size_t free_length = 0;
+	for (int index = free_head; index != -1; index = Unit_Store::NextFree(handles[index]))
+	{
+		if (index < 0 || index >= static_cast<int>(handle_count)
+			|| handles[index].slot >= 0
+			|| ++free_length > handle_count)
+		{
+			return Error("Save file units are corrupt");
+		}
+		last_free = index;
+	}
+	if (last_free != free_tail)
+	{
+		return Error("Save file units are corrupt");
+	}
+	// the hash doesn't cover a unit's timers, so they're checked against the rules
+	// no action keeps a unit busy or cooling down for longer than its rules allow
+	int latest_tick = loaded_tick.value;
+	for (const Unit_Rules & unit_rules : loaded_rules->unit_types)
+	{
+		for (const Action_Rules & action_rules : unit_rules.actions)
+		{
+			latest_tick = std::max(latest_tick, loaded_tick.value
+				+ std::max(action_rules.cooldown.value, action_rules.duration.value));
+		}
+	}
+	auto InTickRange = [&](int value)
+	{
+		return value >= 0 && value <= latest_tick;
+	};
+	int crowded_period = loaded_rules->crowded_decay_period.value;
+
+	Unit_Store & store = world.units;
+	for (std::size_t i = 0; i < handle_count; i++)
+	{
+		store.handles.Append(Unit_Store::Handle{handles[i]});
+	}
+	store.free_head = free_head;
+	store.free_tail = free_tail;
+	reader = sections.Reader(Save_Section_Type::Orders);
+	for (std::size_t slot = 0; slot < unit_count; slot++)
+	{
+		const Saved_Unit & saved = saved_units[slot];
+		if (saved.type < 0 || saved.type >= unit_type_count
+			|| store.SlotOf(UnitID{saved.id}) != static_cast<int>(slot)
+			|| game->players.find(PlayerID{saved.player}) == game->players.end()
+			|| !world.InBounds({saved.x, saved.y})
+			|| saved.pending_type < 0 || saved.pending_type >= action_type_count
+			|| (saved.pending_flags & ~(Saved_Unit::has_location | Saved_Unit::has_target)) != 0
+			|| ((saved.pending_flags & Saved_Unit::has_target) && saved.pending_target < 0)
+			|| !InTickRange(saved.ready_tick)
+			|| !InTickRange(saved.wake_tick)
+			|| saved.crowded_duration < 0
+			|| (crowded_period > 0 && saved.crowded_duration >= crowded_period))
+		{
+			return Error("Save file units are corrupt");
+		}
+		Unit unit;
+		unit.type = &loaded_rules->unit_types[saved.type];
+		unit.id.value = saved.id;
+		unit.player.value = saved.player;
+		unit.position = {saved.x, saved.y};
+		unit.energy.value = saved.energy;
+		unit.crowded_duration.value = saved.crowded_duration;
+		unit.crowding = saved.crowding != 0;
+		unit.pending.type = static_cast<Action_Type>(saved.pending_type);
+		if (saved.pending_flags & Saved_Unit::has_location)
+		{
+			unit.pending.location = Point{saved.pending_x, saved.pending_y};
+		}
+		if (saved.pending_flags & Saved_Unit::has_target)
+		{
+			unit.pending.target = UnitID{saved.pending_target};
+		}
+		unit.ready_tick.value = saved.ready_tick;
+		unit.wake_tick.value = saved.wake_tick;
+		unit.slot = slot;
+		Unit & added = store.hot.Append(std::move(unit));
+		world.spatial_index.Insert(added.id, added.player, added.position);
+
+		Unit_Orders & orders = store.orders.Append(Unit_Orders{});
+		for (auto & cooldown : orders.cooldown_until)
+		{
+			cooldown.value = reader.GetSigned();
+			if (!InTickRange(cooldown.value))
+			{
+				return Error("Save file cooldowns are corrupt");
+			}
+		}
+		std::size_t queue_count = ReadCount(reader);
+		for (std::size_t q = 0; q < queue_count && !reader.failed; q++)
+		{
+			orders.command_queue.push(command_names.Read(reader));
+		}
+		orders.idle_command = command_names.Read(reader);
+	}
+	if (reader.failed)
+	{
+		return Error("Save file command queues are truncated or corrupt");
+	}
+
+	if (keyframe)
+	{
+		auto rebuilt = RebuildDerivedState(*game);
+		if (rebuilt.IsError())
+		{
+			return rebuilt.GetError();
+		}
+	}
+
+	std::size_t chunk_count = 0;
+	const Saved_Chunk * saved_chunks = keyframe
+		? nullptr
+		: sections.Array<Saved_Chunk>(Save_Section_Type::Chunks, -1, chunk_count);
+	std::size_t occupied_count = keyframe ? unit_count : 0;
+	for (std::size_t i = 0; i < chunk_count; i++)
+	{
+		const Saved_Chunk & saved = saved_chunks[i];
+		if (saved.index < 0 || saved.index >= static_cast<int>(world.chunks.chunks.size())
+			|| world.chunks.chunks[saved.index] != nullptr)
+		{
+			return Error("Save file chunks don't match the world size");
+		}
+		for (UnitID occupant : saved.occupancy)
+		{
+			occupied_count += occupant != no_unit;
+		}
+		std::shared_ptr<World_Chunk> chunk{new World_Chunk{}};
+		chunk->owner = world.chunks.owner;
+		chunk->origin = {
+			(saved.index % world.chunks.chunks_wide) * World_Chunk::size,
+			(saved.index / world.chunks.chunks_wide) * World_Chunk::size
+		};
+		std::copy_n(saved.occupancy, World_Chunk::tile_count, chunk->occupancy);
+		std::copy_n(saved.terrain, World_Chunk::tile_count, chunk->terrain);
+		std::copy_n(saved.neighbor_count, World_Chunk::tile_count, chunk->neighbor_count);
+		world.chunks.chunks[saved.index] = std::move(chunk);
+	}
+	// every unit occupies its own tile and nothing else is occupied
+	// so the count and a check of each unit's tile covers all of them
+	if (occupied_count != unit_count)
+	{
+		return Error("Save file occupancy doesn't match its units");
+	}
+	for (const Unit & unit : std::as_const(store))
+	{
+		if (world.GetUnitIDAt(unit.position) != unit.id)
+		{
+			return Error("Save file occupancy doesn't match its units");
+		}
+	}
+	// the hash covers each unit's type, position, energy and pending action
+	// so it catches corrupt values there that the checks above can't
+	if (world.ComputeHash() != world.hash)
+	{
+		return Error("Save file state doesn't match its hash");
+	}
+
+	std::size_t event_count;
+	const Game_Event * saved_events = sections.Array<Game_Event>(Save_Section_Type::Events, -1, event_count);
+	// the ring may have grown past its initial size, but always by doubling
+	// and it holds every saved event at the index it had when it was saved
+	if (saved_events == nullptr
+		|| event_capacity < static_cast<uint64_t>(game->events.events.size)
+		|| event_capacity > max_event_capacity
+		|| (event_capacity & (event_capacity - 1)) != 0
+		|| game->events.overwritten > game->events.written
+		|| event_count != game->events.written - game->events.overwritten
+		|| event_count > event_capacity)
+	{
+		return Error("Save file events are missing or corrupt");
+	}
+	game->events.events = {};
+	for (uint64_t i = 0; i < event_capacity; i++)
+	{
+		game->events.events.Append({});
+	}
+	for (std::size_t i = 0; i < event_count; i++)
+	{
+		// filters shift by the type, so it has to be one there is a bit for
+		int type = static_cast<int>(saved_events[i].type);
+		if (type < 0 || type >= event_type_count)
+		{
+			return Error("Save file events are missing or corrupt");
+		}
+		uint64_t index = game->events.overwritten + i;
+		game->events.events[index & game->events.Mask()] = saved_events[i];
+	}
+
+	return std::move(game);
+}
+
+} // namespace Brushlink
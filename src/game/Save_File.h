@@ -0,0 +1,111 @@
+#pragma once
+#ifndef BRUSHLINK_SAVE_FILE_H
+#define BRUSHLINK_SAVE_FILE_H
+
+#include <cstdint>
+#include <type_traits>
+
+#include "Game_Basic_Types.h"
+#include "Chunk_Map.h"
+#include "Unit_Store.h"
+#include "Event.h"
+
+namespace Brushlink
+{
+
+// the full game state, written by Game::Save and read back by Game::Load
+//
+// a header and a table of sections, then the sections themselves
+// the bulky state (units, chunks, vision and events) is stored as flat arrays
+// of fixed layout records, so loading maps the file and copies them into place
+// with only the unit type pointers and spatial index to fix up afterwards
+// the small, irregular state (command queues, player values, schedules)
+// is varint encoded with Byte_Writer
+//
+// keyframes leave out the chunks and vision, which loading rebuilds from the units,
+// and every event from before the last tick, which is all a script can read
+//
+// sections start on 8 byte boundaries so the arrays can be read where they are mapped
+// everything is little endian, the magic won't match if read on a big endian machine
+
+enum class Save_Section_Type : uint32_t
+{
+	State, // varint, settings, rules, schedules and everything else on Game
+	Players, // varint, contexts and command groups
+	Units, // Saved_Unit by slot
+	Orders, // varint, Unit_Orders by slot
+	Handles, // Unit_Store::Handle
+	Free_Handles, // int32_t head and tail of the free queue, linked through the handles
+	Chunks, // Saved_Chunk, only the allocated ones, not in keyframes
+	Vision_Counts, // uint16_t per tile, one section per player, not in keyframes
+	Vision_Visible, // Area_Bits words, one section per player, not in keyframes
+	Fog_Mask, // uint8_t per tile, one section per player, not in keyframes
+	Events, // Game_Event, oldest first, from Event_Stream::overwritten up to written
+};
+
+struct Save_Header
+{
+	static constexpr uint32_t magic_value = 0x56534c42; // "BLSV"
+	static constexpr uint32_t current_version = 6;
+	static constexpr uint32_t keyframe = 1; // flag, derived state is left out
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t section_count;
+	uint32_t flags;
+	uint64_t file_size; // to catch truncated files before reading any section
+};
+
+// follows the header, section_count of them
+struct Save_Section
+{
+	Save_Section_Type type;
+	int32_t player; // -1 for sections that don't belong to a player
+	uint64_t offset; // from the start of the file
+	uint64_t size; // in bytes
+};
+
+struct Saved_Unit
+{
+	int32_t type;
+	int32_t id;
+	int32_t player;
+	int32_t x;
+	int32_t y;
+	int32_t energy;
+	int32_t crowded_duration;
+	int32_t crowding;
+	int32_t pending_type;
+	int32_t pending_flags; // has_location and has_target
+	int32_t pending_x;
+	int32_t pending_y;
+	int32_t pending_target;
+	int32_t ready_tick;
+	int32_t wake_tick;
+	int32_t reserved;
+
+	static constexpr int32_t has_location = 1;
+	static constexpr int32_t has_target = 2;
+};
+
+struct Saved_Chunk
+{
+	int32_t index; // into Chunk_Map::chunks
+	int32_t reserved;
+	UnitID occupancy[World_Chunk::tile_count];
+	uint8_t terrain[World_Chunk::tile_count];
+	uint8_t neighbor_count[World_Chunk::tile_count];
+};
+
+// the arrays below are written and read as raw bytes
+static_assert(sizeof(Save_Header) == 24);
+static_assert(sizeof(Save_Section) == 24);
+static_assert(sizeof(Saved_Unit) == 64);
+static_assert(sizeof(Saved_Chunk) % 8 == 0);
+static_assert(sizeof(UnitID) == 4 && std::is_trivially_copyable_v<UnitID>);
+static_assert(sizeof(Unit_Store::Handle) == 8 && std::is_trivially_copyable_v<Unit_Store::Handle>);
+static_assert(std::is_trivially_copyable_v<Game_Event>);
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_SAVE_FILE_H
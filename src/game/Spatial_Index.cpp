@@ -0,0 +1,254 @@
+
+#include "Spatial_Index.h"
+
+#include "Circle_Stencil.h"
+
+#include <limits>
+
+namespace Brushlink
+{
+
+namespace
+{
+
+struct Candidate
+{
+	int distance_squared;
+	UnitID id;
+
+	bool operator<(const Candidate & other) const
+	{
+		if (distance_squared != other.distance_squared)
+		{
+			return distance_squared < other.distance_squared;
+		}
+		return id < other.id;
+	}
+};
+
+int DistanceSquared(Point a, Point b)
+{
+	Point d = a - b;
+	return d.x * d.x + d.y * d.y;
+}
+
+std::vector<UnitID> SortedIDs(std::vector<Candidate> & candidates)
+{
+	std::sort(candidates.begin(), candidates.end());
+	std::vector<UnitID> ids;
+	ids.reserve(candidates.size());
+	for (auto & candidate : candidates)
+	{
+		ids.push_back(candidate.id);
+	}
+	return ids;
+}
+
+} // namespace
+
+Spatial_Index::Spatial_Index(int width, int height)
+	: buckets_wide(std::max(1, (width + bucket_size - 1) / bucket_size))
+	, buckets_high(std::max(1, (height + bucket_size - 1) / bucket_size))
+{
+	for (int i = 0; i < buckets_wide * buckets_high; i++)
+	{
+		buckets.Append({});
+	}
+}
+
+void Spatial_Index::Insert(UnitID id, PlayerID player, Point position)
+{
+	buckets[BucketIndex(position)].push_back({id, player, position});
+}
+
+void Spatial_Index::Remove(UnitID id, Point position)
+{
+	auto & bucket = buckets[BucketIndex(position)];
+	for (auto & entry : bucket)
+	{
+		if (entry.id == id)
+		{
+			entry = bucket.back();
+			bucket.pop_back();
+			return;
+		}
+	}
+}
+
+void Spatial_Index::Move(UnitID id, Point from, Point to)
+{
+	int from_index = BucketIndex(from);
+	int to_index = BucketIndex(to);
+	auto & bucket = buckets[from_index];
+	for (auto & entry : bucket)
+	{
+		if (entry.id != id)
+		{
+			continue;
+		}
+		entry.position = to;
+		if (from_index != to_index)
+		{
+			buckets[to_index].push_back(entry);
+			entry = bucket.back();
+			bucket.pop_back();
+		}
+		return;
+	}
+}
+
+std::vector<UnitID> Spatial_Index::WithinRadius(Point center, float radius, Spatial_Filter filter) const
+{
+	const Circle_Stencil & stencil = Circle_Stencil::Get(radius);
+	std::vector<Candidate> found;
+	ForEachInBuckets(
+		(center.x - stencil.bounds) >> bucket_bits,
+		(center.y - stencil.bounds) >> bucket_bits,
+		(center.x + stencil.bounds) >> bucket_bits,
+		(center.y + stencil.bounds) >> bucket_bits,
+		[&](const Entry & entry)
+		{
+			if (filter.Accepts(entry.player, entry.position)
+				&& stencil.Contains(center, entry.position))
+			{
+				found.push_back({DistanceSquared(center, entry.position), entry.id});
+			}
+		});
+	return SortedIDs(found);
+}
+
+std::vector<UnitID> Spatial_Index::WithinBox(Point bottom_left, Point top_right, Spatial_Filter filter) const
+{
+	Point center {
+		(bottom_left.x + top_right.x) / 2,
+		(bottom_left.y + top_right.y) / 2
+	};
+	std::vector<Candidate> found;
+	ForEachInBuckets(
+		bottom_left.x >> bucket_bits,
+		bottom_left.y >> bucket_bits,
+		top_right.x >> bucket_bits,
+		top_right.y >> bucket_bits,
+		[&](const Entry & entry)
+		{
+			if (filter.Accepts(entry.player, entry.position)
+				&& entry.position.x >= bottom_left.x && entry.position.x <= top_right.x
+				&& entry.position.y >= bottom_left.y && entry.position.y <= top_right.y)
+			{
+				found.push_back({DistanceSquared(center, entry.position), entry.id});
+			}
+		});
+	return SortedIDs(found);
+}
+
+std::vector<UnitID> Spatial_Index::WithinArea(const Area_Bits & area, Spatial_Filter filter) const
+{
+	std::vector<Candidate> found;
+	if (area.word_width == 0 || area.height == 0)
+	{
+		return {};
+	}
+	int x_min = std::max((area.word_x * Area_Bits::word_bits) >> bucket_bits, 0);
+	int x_max = std::min(((area.word_x + area.word_width) * Area_Bits::word_bits - 1) >> bucket_bits, buckets_wide - 1);
+	int y_min = std::max(area.y >> bucket_bits, 0);
+	int y_max = std::min((area.y + area.height - 1) >> bucket_bits, buckets_high - 1);
+	for (int y = y_min; y <= y_max; y++)
+	{
+		int row_min = std::max(y * bucket_size - area.y, 0);
+		int row_max = std::min((y + 1) * bucket_size - area.y, area.height);
+		for (int x = x_min; x <= x_max; x++)
+		{
+			int column = Area_Bits::WordColumn(x * bucket_size) - area.word_x;
+			uint64_t mask = ((uint64_t{1} << bucket_size) - 1) << ((x * bucket_size) & (Area_Bits::word_bits - 1));
+			bool overlaps = false;
+			for (int row = row_min; row < row_max && !overlaps; row++)
+			{
+				overlaps = (area.words[row * area.word_width + column] & mask) != 0;
+			}
+			if (!overlaps)
+			{
+				continue;
+			}
+			for (auto & entry : buckets[y * buckets_wide + x])
+			{
+				if (filter.Accepts(entry.player, entry.position)
+					&& area.Contains(entry.position))
+				{
+					found.push_back({0, entry.id}); // no center, so by id
+				}
+			}
+		}
+	}
+	return SortedIDs(found);
+}
+
+std::vector<UnitID> Spatial_Index::Nearest(Point center, int count, Spatial_Filter filter) const
+{
+	std::vector<Candidate> best;
+	if (count <= 0)
+	{
+		return {};
+	}
+	int bucket_x = std::min(std::max(center.x >> bucket_bits, 0), buckets_wide - 1);
+	int bucket_y = std::min(std::max(center.y >> bucket_bits, 0), buckets_high - 1);
+	int max_ring = std::max(buckets_wide, buckets_high);
+	for (int ring = 0; ring <= max_ring; ring++)
+	{
+		auto VisitBucket = [&](int x, int y)
+		{
+			if (x < 0 || x >= buckets_wide
+				|| y < 0 || y >= buckets_high)
+			{
+				return;
+			}
+			for (auto & entry : buckets[y * buckets_wide + x])
+			{
+				if (filter.Accepts(entry.player, entry.position))
+				{
+					best.push_back({DistanceSquared(center, entry.position), entry.id});
+				}
+			}
+		};
+		// only the outer edge of the square of buckets is new this ring
+		if (ring == 0)
+		{
+			VisitBucket(bucket_x, bucket_y);
+		}
+		for (int x = bucket_x - ring; ring > 0 && x <= bucket_x + ring; x++)
+		{
+			VisitBucket(x, bucket_y - ring);
+			VisitBucket(x, bucket_y + ring);
+		}
+		for (int y = bucket_y - ring + 1; ring > 0 && y <= bucket_y + ring - 1; y++)
+		{
+			VisitBucket(bucket_x - ring, y);
+			VisitBucket(bucket_x + ring, y);
+		}
+		if (static_cast<int>(best.size()) < count)
+		{
+			continue;
+		}
+		std::sort(best.begin(), best.end());
+		best.resize(count);
+		// closest any unvisited tile can be along either axis
+		// sides past the edge of the map have nothing left to visit
+		// clamped for a center off the map, which is outside the visited square
+		constexpr int none = std::numeric_limits<int>::max();
+		int unvisited = std::max(0, std::min({
+			bucket_x - ring > 0 ? center.x - (bucket_x - ring) * bucket_size + 1 : none,
+			bucket_x + ring + 1 < buckets_wide ? (bucket_x + ring + 1) * bucket_size - center.x : none,
+			bucket_y - ring > 0 ? center.y - (bucket_y - ring) * bucket_size + 1 : none,
+			bucket_y + ring + 1 < buckets_high ? (bucket_y + ring + 1) * bucket_size - center.y : none}));
+		if (unvisited == none)
+		{
+			break;
+		}
+		if (best.back().distance_squared < unvisited * unvisited)
+		{
+			break;
+		}
+	}
+	return SortedIDs(best);
+}
+
+} // namespace Brushlink
@@ -0,0 +1,124 @@
+#pragma once
+#ifndef BRUSHLINK_SPATIAL_INDEX_H
+#define BRUSHLINK_SPATIAL_INDEX_H
+
+#include <algorithm>
+#include <vector>
+
+#include "Game_Basic_Types.h"
+#include "Location.h"
+#include "Area_Bits.h"
+#include "Paged_Array.h"
+
+namespace Brushlink
+{
+
+enum class Player_Filter
+{
+	Any,
+	Owned_By,
+	Not_Owned_By,
+};
+
+struct Spatial_Filter
+{
+	Player_Filter relation {Player_Filter::Any};
+	PlayerID player {-1};
+	// when set, other players' units are only accepted inside it, see World::SeenBy
+	const Area_Bits * visible {nullptr};
+
+	inline bool Accepts(PlayerID owner, Point position) const
+	{
+		if (visible != nullptr
+			&& owner != player
+			&& !visible->Contains(position))
+		{
+			return false;
+		}
+		switch(relation)
+		{
+		case Player_Filter::Any:
+			return true;
+		case Player_Filter::Owned_By:
+			return owner == player;
+		case Player_Filter::Not_Owned_By:
+			return owner != player;
+		}
+		return true;
+	}
+};
+
+// units bucketed on a coarse uniform grid
+// so area and nearest queries only visit the buckets they overlap
+// query results are sorted by distance then UnitID to stay deterministic
+// buckets are paged like the units so a snapshot shares them, see Cow_Owner.h
+struct Spatial_Index
+{
+	static constexpr int bucket_bits = 3;
+	static constexpr int bucket_size = 1 << bucket_bits;
+	// so a bucket's columns always fall in a single Area_Bits word
+	static_assert(Area_Bits::word_bits % bucket_size == 0);
+
+	struct Entry
+	{
+		UnitID id;
+		PlayerID player;
+		Point position;
+	};
+
+	int buckets_wide = 0;
+	int buckets_high = 0;
+	Paged_Array<std::vector<Entry>> buckets;
+
+	Spatial_Index() = default;
+
+	Spatial_Index(int width, int height);
+
+	void Insert(UnitID id, PlayerID player, Point position);
+	void Remove(UnitID id, Point position);
+	void Move(UnitID id, Point from, Point to);
+
+	inline void Fork()
+	{
+		buckets.Fork();
+	}
+
+	// units inside Circle_Stencil::Get(radius) around center
+	std::vector<UnitID> WithinRadius(Point center, float radius, Spatial_Filter filter = {}) const;
+	// inclusive box
+	std::vector<UnitID> WithinBox(Point bottom_left, Point top_right, Spatial_Filter filter = {}) const;
+	// skips buckets that don't overlap any tile of the area, e.g. a player's vision
+	std::vector<UnitID> WithinArea(const Area_Bits & area, Spatial_Filter filter = {}) const;
+	std::vector<UnitID> Nearest(Point center, int count, Spatial_Filter filter = {}) const;
+
+	// helpers
+	inline int BucketIndex(Point p) const
+	{
+		int x = std::min(std::max(p.x >> bucket_bits, 0), buckets_wide - 1);
+		int y = std::min(std::max(p.y >> bucket_bits, 0), buckets_high - 1);
+		return y * buckets_wide + x;
+	}
+
+	template<typename F>
+	void ForEachInBuckets(int x_min, int y_min, int x_max, int y_max, F && f) const
+	{
+		x_min = std::max(x_min, 0);
+		y_min = std::max(y_min, 0);
+		x_max = std::min(x_max, buckets_wide - 1);
+		y_max = std::min(y_max, buckets_high - 1);
+		for (int y = y_min; y <= y_max; y++)
+		{
+			for (int x = x_min; x <= x_max; x++)
+			{
+				for (auto & entry : buckets[y * buckets_wide + x])
+				{
+					f(entry);
+				}
+			}
+		}
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_SPATIAL_INDEX_H
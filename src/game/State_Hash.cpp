@@ -0,0 +1,174 @@
+
+#include "State_Hash.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Brushlink
+{
+
+const char * GetName(Hash_Field field)
+{
+	switch (field)
+	{
+	case Hash_Field::Units:
+		return "Units";
+	case Hash_Field::Positions:
+		return "Positions";
+	case Hash_Field::Energy:
+		return "Energy";
+	case Hash_Field::Pending:
+		return "Pending";
+	case Hash_Field::Random:
+		return "Random";
+	}
+	return "Unknown";
+}
+
+void State_Hash::ToggleUnit(const Unit & unit)
+{
+	Toggle(Hash_Field::Units, OfUnit(unit));
+	Toggle(Hash_Field::Positions, OfPosition(unit.id, unit.position));
+	Toggle(Hash_Field::Energy, OfEnergy(unit.id, unit.energy));
+	Toggle(Hash_Field::Pending, OfPending(unit.id, unit.pending));
+}
+
+uint64_t State_Hash::Combined() const
+{
+	uint64_t combined = 0;
+	for (auto field : fields)
+	{
+		combined = Combine(combined, field);
+	}
+	return combined;
+}
+
+uint64_t State_Hash::Mix(uint64_t value)
+{
+	// splitmix64 finalizer
+	value += 0x9e3779b97f4a7c15ull;
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+	return value ^ (value >> 31);
+}
+
+uint64_t State_Hash::Combine(uint64_t seed, uint64_t value)
+{
+	return Mix(seed ^ Mix(value));
+}
+
+uint64_t State_Hash::OfUnit(const Unit & unit)
+{
+	uint64_t hash = Combine(static_cast<uint64_t>(Hash_Field::Units), unit.id.value);
+	hash = Combine(hash, static_cast<uint64_t>(unit.type->type));
+	return Combine(hash, unit.player.value);
+}
+
+uint64_t State_Hash::OfPosition(UnitID id, Point position)
+{
+	uint64_t hash = Combine(static_cast<uint64_t>(Hash_Field::Positions), id.value);
+	hash = Combine(hash, static_cast<uint32_t>(position.x));
+	return Combine(hash, static_cast<uint32_t>(position.y));
+}
+
+uint64_t State_Hash::OfEnergy(UnitID id, Energy energy)
+{
+	uint64_t hash = Combine(static_cast<uint64_t>(Hash_Field::Energy), id.value);
+	return Combine(hash, static_cast<uint32_t>(energy.value));
+}
+
+uint64_t State_Hash::OfPending(UnitID id, const Action_Step & pending)
+{
+	uint64_t hash = Combine(static_cast<uint64_t>(Hash_Field::Pending), id.value);
+	hash = Combine(hash, static_cast<uint64_t>(pending.type));
+	if (pending.location)
+	{
+		hash = Combine(hash, static_cast<uint32_t>(pending.location->x));
+		hash = Combine(hash, static_cast<uint32_t>(pending.location->y));
+	}
+	if (pending.target)
+	{
+		hash = Combine(hash, static_cast<uint32_t>(pending.target->value) | (uint64_t{1} << 32));
+	}
+	return hash;
+}
+
+void Hash_Recorder::Record(Ticks tick, const State_Hash & hash)
+{
+	stream.push_back({tick, hash});
+}
+
+ErrorOr<Success> Hash_Recorder::Save(const std::string & file_name) const
+{
+	FILE * file = fopen(file_name.c_str(), "w");
+	if (file == nullptr)
+	{
+		return Error("Couldn't open hash stream file for writing");
+	}
+	// one line per tick: tick, then each field in hex
+	for (auto & entry : stream)
+	{
+		fprintf(file, "%d", entry.tick.value);
+		for (auto field : entry.hash.fields)
+		{
+			fprintf(file, " %016llx", static_cast<unsigned long long>(field));
+		}
+		fprintf(file, "\n");
+	}
+	fclose(file);
+	return Success();
+}
+
+ErrorOr<Hash_Recorder> Hash_Recorder::Load(const std::string & file_name)
+{
+	FILE * file = fopen(file_name.c_str(), "r");
+	if (file == nullptr)
+	{
+		return Error("Couldn't open hash stream file for reading");
+	}
+	Hash_Recorder recorder;
+	Entry entry;
+	while (fscanf(file, "%d", &entry.tick.value) == 1)
+	{
+		for (auto & field : entry.hash.fields)
+		{
+			unsigned long long value = 0;
+			if (fscanf(file, "%llx", &value) != 1)
+			{
+				fclose(file);
+				return Error("Hash stream file has a truncated line");
+			}
+			field = value;
+		}
+		recorder.stream.push_back(entry);
+	}
+	fclose(file);
+	return recorder;
+}
+
+std::optional<Desync_Report> Hash_Recorder::FindDesync(const Hash_Recorder & other) const
+{
+	std::size_t count = std::min(stream.size(), other.stream.size());
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const Entry & mine = stream[i];
+		const Entry & theirs = other.stream[i];
+		if (mine.tick != theirs.tick)
+		{
+			// the streams skipped different ticks, nothing after this lines up
+			return Desync_Report{
+				Ticks{std::min(mine.tick.value, theirs.tick.value)},
+				std::nullopt};
+		}
+		for (int field = 0; field < hash_field_count; field++)
+		{
+			if (mine.hash.fields[field] != theirs.hash.fields[field])
+			{
+				return Desync_Report{mine.tick, static_cast<Hash_Field>(field)};
+			}
+		}
+	}
+	return std::nullopt;
+}
+
+} // namespace Brushlink
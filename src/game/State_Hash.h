@@ -0,0 +1,109 @@
+#pragma once
+#ifndef BRUSHLINK_STATE_HASH_H
+#define BRUSHLINK_STATE_HASH_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "BuiltinTypedefs.h"
+
+#include "Unit.h"
+#include "Game_Time.h"
+
+namespace Brushlink
+{
+
+enum class Hash_Field
+{
+	Units, // id, type and owner
+	Positions,
+	Energy,
+	Pending,
+	Random
+};
+
+constexpr int hash_field_count = static_cast<int>(Hash_Field::Random) + 1;
+
+const char * GetName(Hash_Field field);
+
+// 64 bit hash of the simulation state, kept up to date as the state changes
+// each field is the xor of one hash per unit, so a change only has to
+// remove the old value and add the new one, in any order
+struct State_Hash
+{
+	std::array<uint64_t, hash_field_count> fields{};
+
+	inline void Toggle(Hash_Field field, uint64_t value)
+	{
+		fields[static_cast<int>(field)] ^= value;
+	}
+
+	inline void Set(Hash_Field field, uint64_t value)
+	{
+		fields[static_cast<int>(field)] = value;
+	}
+
+	inline uint64_t Get(Hash_Field field) const
+	{
+		return fields[static_cast<int>(field)];
+	}
+
+	// adds or removes every field of the unit
+	void ToggleUnit(const Unit & unit);
+
+	uint64_t Combined() const;
+
+	bool operator==(const State_Hash & other) const
+	{
+		return fields == other.fields;
+	}
+
+	bool operator!=(const State_Hash & other) const
+	{
+		return !(*this == other);
+	}
+
+	// per unit values, each salted by field so equal values in different fields differ
+	static uint64_t Mix(uint64_t value);
+	static uint64_t Combine(uint64_t seed, uint64_t value);
+	static uint64_t OfUnit(const Unit & unit);
+	static uint64_t OfPosition(UnitID id, Point position);
+	static uint64_t OfEnergy(UnitID id, Energy energy);
+	static uint64_t OfPending(UnitID id, const Action_Step & pending);
+};
+
+struct Desync_Report
+{
+	Ticks tick;
+	// empty if the streams recorded different ticks from here on,
+	// so none of the hashes after it line up to compare
+	std::optional<Hash_Field> field;
+};
+
+// records the hash at the end of every tick so two runs of the same inputs
+// can be compared, and the first tick and field that differ reported
+struct Hash_Recorder
+{
+	struct Entry
+	{
+		Ticks tick;
+		State_Hash hash;
+	};
+
+	std::vector<Entry> stream;
+
+	void Record(Ticks tick, const State_Hash & hash);
+
+	ErrorOr<Success> Save(const std::string & file_name) const;
+	static ErrorOr<Hash_Recorder> Load(const std::string & file_name);
+
+	// empty if the streams agree on every tick both recorded
+	std::optional<Desync_Report> FindDesync(const Hash_Recorder & other) const;
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_STATE_HASH_H
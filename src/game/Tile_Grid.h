@@ -0,0 +1,76 @@
+#pragma once
+#ifndef BRUSHLINK_TILE_GRID_H
+#define BRUSHLINK_TILE_GRID_H
+
+#include <algorithm>
+#include <vector>
+
+#include "Location.h"
+
+namespace Brushlink
+{
+
+// flat row-major storage with one value per world tile
+// reads outside the grid return the empty value, writes outside are dropped
+template<typename T>
+struct Tile_Grid
+{
+	int width = 0;
+	int height = 0;
+	T empty{};
+	std::vector<T> tiles;
+
+	Tile_Grid() = default;
+
+	Tile_Grid(int width, int height, T empty = T{})
+		: width(width)
+		, height(height)
+		, empty(empty)
+		, tiles(static_cast<std::size_t>(width) * height, empty)
+	{ }
+
+	inline bool InBounds(Point p) const
+	{
+		// the unsigned cast folds the negative checks into the upper bound check
+		return static_cast<unsigned>(p.x) < static_cast<unsigned>(width)
+			&& static_cast<unsigned>(p.y) < static_cast<unsigned>(height);
+	}
+
+	inline std::size_t Index(Point p) const
+	{
+		return static_cast<std::size_t>(p.y) * width + p.x;
+	}
+
+	inline const T & Get(Point p) const
+	{
+		if (!InBounds(p))
+		{
+			return empty;
+		}
+		return tiles[Index(p)];
+	}
+
+	inline bool Assign(Point p, T value)
+	{
+		if (!InBounds(p))
+		{
+			return false;
+		}
+		tiles[Index(p)] = value;
+		return true;
+	}
+
+	inline bool IsEmpty(Point p) const
+	{
+		return Get(p) == empty;
+	}
+
+	inline void Clear()
+	{
+		std::fill(tiles.begin(), tiles.end(), empty);
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_TILE_GRID_H
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef BRUSHLINK_TIMING_WHEEL_H
+#define BRUSHLINK_TIMING_WHEEL_H
+
+#include <vector>
+
+#include "Game_Basic_Types.h"
+#include "Game_Time.h"
+
+namespace Brushlink
+{
+
+// units waiting for a known tick, bucketed by tick so each tick
+// only looks at the units due then instead of scanning all of them
+// entries further out than one turn of the wheel stay in their bucket until their turn comes
+struct Timing_Wheel
+{
+	static constexpr int wheel_bits = 8;
+	static constexpr int wheel_size = 1 << wheel_bits;
+
+	struct Entry
+	{
+		Ticks tick;
+		UnitID unit;
+	};
+
+	std::vector<std::vector<Entry>> wheel{wheel_size};
+
+	inline void Add(UnitID unit, Ticks tick)
+	{
+		wheel[tick.value & (wheel_size - 1)].push_back({tick, unit});
+	}
+
+	// removes every entry due at or before now and calls f(unit, tick) for each
+	// callers check the unit still exists, ids of removed units don't resolve
+	template<typename F>
+	void TakeDue(Ticks now, F && f)
+	{
+		std::vector<Entry> & bucket = wheel[now.value & (wheel_size - 1)];
+		// f may add entries, possibly to this bucket, those wait for a later turn
+		std::size_t count = bucket.size();
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < count; i++)
+		{
+			Entry entry = bucket[i];
+			if (entry.tick > now)
+			{
+				bucket[kept++] = entry;
+				continue;
+			}
+			f(entry.unit, entry.tick);
+		}
+		for (std::size_t i = count; i < bucket.size(); i++)
+		{
+			bucket[kept++] = bucket[i];
+		}
+		bucket.resize(kept);
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_TIMING_WHEEL_H
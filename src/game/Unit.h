@@ -2,6 +2,8 @@
 #ifndef BRUSHLINK_UNIT_H
 #define BRUSHLINK_UNIT_H
 
+#include <array>
+#include <list>
 #include <vector>
 #include <queue>
 #include <utility>
@@ -13,37 +15,52 @@
 #include "Game_Basic_Types.h"
 #include "Command.h"
 #include "Action.h"
+#include "Ruleset.h"
 
 namespace Brushlink
 {
 
+// authored rules for a unit type, see Unit_Rules for the compiled form
 struct Unit_Settings
 {
 	Unit_Type type;
 	Energy starting_energy {6};
 	Energy max_energy {12};
 	std::pair<Energy, Seconds> recharge_rate {{1}, {1.0}};
-	Map<Player_Graphics, std::shared_ptr<Tigr>> drawn_body;
 	Map<Action_Type, Action_Settings> actions;
 	float vision_radius = 4.5;
 	Map<Action_Type, Action_Magnitude_Modifier> targeted_modifiers;
 };
 
+// fields read or written by most units every tick
+// kept small so the simulation can stream through them, see Unit_Store
 struct Unit
 {
-	Unit_Settings * type;
+	const Unit_Rules * type; // owned by the game's Ruleset
 	UnitID id;
 	PlayerID player;
 	Point position;
 	Energy energy;
 	Ticks crowded_duration;
+	bool crowding = false; // in Game::crowding
 
 	Action_Step pending; // if pending.type == Idle there is no pending
-	Map<Action_Type, Ticks> history;
+	Ticks ready_tick; // busy with the duration of its last action until this tick
+	Ticks wake_tick; // parked in the Action_Schedule until this tick
+	int slot = -1; // dense index in Unit_Store, shared with Unit_Orders
+};
+
+// only touched when a unit evaluates a command or takes an action
+struct Unit_Orders
+{
+	// per Action_Type, the first tick it can be taken again
+	std::array<Ticks, action_type_count> cooldown_until{};
 	// Command type in unit context?
 	// need an already executed type stored by value
 	// and a repeatedly executed type full tree
-	std::queue<value_ptr<Action_Command> > command_queue;
+	// list backed so the empty queue most units have doesn't allocate
+	// a deque allocates a block up front
+	std::queue<value_ptr<Action_Command>, std::list<value_ptr<Action_Command> > > command_queue;
 	value_ptr<Action_Command> idle_command;
 };
 
@@ -0,0 +1,73 @@
+
+#include "Unit_Store.h"
+
+namespace Brushlink
+{
+
+Unit * Unit_Store::Add(Unit && unit)
+{
+	int index;
+	if (free_head >= 0)
+	{
+		index = free_head;
+		free_head = NextFree(handles[index]);
+		if (free_head < 0)
+		{
+			free_tail = -1;
+		}
+	}
+	else
+	{
+		if (handles.size > index_mask)
+		{
+			return nullptr;
+		}
+		index = handles.size;
+		handles.Append(Handle{});
+	}
+	Handle & handle = handles[index];
+	handle.slot = hot.size;
+	unit.id = MakeID(index, handle.generation);
+	unit.slot = handle.slot;
+	orders.Append(Unit_Orders{});
+	return &hot.Append(std::move(unit));
+}
+
+void Unit_Store::Remove(UnitID id)
+{
+	int slot = SlotOf(id);
+	if (slot < 0)
+	{
+		return;
+	}
+	int index = IndexOf(id);
+	Handle & handle = handles[index];
+	handle.slot = -1;
+	// any copies of id held elsewhere are now stale
+	handle.generation = (handle.generation + 1) & generation_mask;
+	if (handle.generation != 0)
+	{
+		if (free_tail >= 0)
+		{
+			handles[free_tail].slot = -2 - index;
+		}
+		else
+		{
+			free_head = index;
+		}
+		free_tail = index;
+	}
+
+	int last = hot.size - 1;
+	if (slot != last)
+	{
+		hot[slot] = std::move(hot[last]);
+		orders[slot] = std::move(orders[last]);
+		hot[slot].slot = slot;
+		handles[IndexOf(hot[slot].id)].slot = slot;
+	}
+	hot.PopBack();
+	orders.PopBack();
+}
+
+} // namespace Brushlink
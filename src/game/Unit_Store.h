@@ -0,0 +1,145 @@
+#pragma once
+#ifndef BRUSHLINK_UNIT_STORE_H
+#define BRUSHLINK_UNIT_STORE_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "BuiltinTypedefs.h"
+
+#include "Game_Basic_Types.h"
+#include "Paged_Array.h"
+#include "Unit.h"
+
+namespace Brushlink
+{
+
+// units packed by a dense slot
+// the hot Unit fields that every tick streams through sit in one array
+// and the command queue and cooldowns live in a side table at the same slot
+// removal swaps the last unit into the hole to keep the arrays dense
+//
+// UnitIDs are generational handles: the low bits index a sparse table
+// that points at the dense slot, the high bits must match that entry's
+// generation, so ids of dead units are detected instead of aliasing new ones
+struct Unit_Store
+{
+	static constexpr int index_bits = 20;
+	static constexpr int index_mask = (1 << index_bits) - 1;
+	static constexpr int generation_mask = (1 << (31 - index_bits)) - 1;
+
+	struct Handle
+	{
+		int generation = 0;
+		// negative while free, -2 - the next free handle, or -1 for the last or a retired one
+		int slot = -1;
+	};
+
+	Paged_Array<Unit> hot;
+	Paged_Array<Unit_Orders> orders;
+	Paged_Array<Handle> handles;
+	// free handles are reused first in, first out so churn is spread over all of them
+	// instead of wrapping the generation of the few most recently freed
+	// a handle whose generation wraps is retired rather than freed
+	// the queue is linked through the free handles' slots, so a fork shares it with the handles
+	int free_head = -1;
+	int free_tail = -1;
+
+	template<typename Store, typename Value>
+	struct Basic_Iterator
+	{
+		Store * store;
+		int slot;
+
+		inline Value & operator*() const { return store->hot[slot]; }
+		inline Basic_Iterator & operator++() { slot++; return *this; }
+		inline bool operator!=(const Basic_Iterator & other) const { return slot != other.slot; }
+	};
+	using Iterator = Basic_Iterator<Unit_Store, Unit>;
+	// doesn't copy shared pages, see Paged_Array
+	using Const_Iterator = Basic_Iterator<const Unit_Store, const Unit>;
+
+	inline Iterator begin() { return {this, 0}; }
+	inline Iterator end() { return {this, hot.size}; }
+	inline Const_Iterator begin() const { return {this, 0}; }
+	inline Const_Iterator end() const { return {this, hot.size}; }
+
+	static inline int NextFree(const Handle & handle)
+	{
+		return -2 - handle.slot;
+	}
+
+	static inline int IndexOf(UnitID id)
+	{
+		return id.value & index_mask;
+	}
+
+	static inline int GenerationOf(UnitID id)
+	{
+		return (id.value >> index_bits) & generation_mask;
+	}
+
+	static inline UnitID MakeID(int index, int generation)
+	{
+		return UnitID{(generation << index_bits) | index};
+	}
+
+	inline int Count() const
+	{
+		return hot.size;
+	}
+
+	// -1 for stale or invalid ids
+	inline int SlotOf(UnitID id) const
+	{
+		if (id.value < 0)
+		{
+			return -1;
+		}
+		int index = IndexOf(id);
+		if (index >= handles.size
+			|| handles[index].generation != GenerationOf(id))
+		{
+			return -1;
+		}
+		return std::max(-1, handles[index].slot);
+	}
+
+	inline Unit * Find(UnitID id)
+	{
+		int slot = SlotOf(id);
+		return slot < 0 ? nullptr : &hot[slot];
+	}
+
+	inline const Unit * Find(UnitID id) const
+	{
+		int slot = SlotOf(id);
+		return slot < 0 ? nullptr : &hot[slot];
+	}
+
+	inline Unit_Orders & OrdersOf(const Unit & unit)
+	{
+		return orders[unit.slot];
+	}
+
+	inline const Unit_Orders & OrdersOf(const Unit & unit) const
+	{
+		return orders[unit.slot];
+	}
+
+	// assigns the unit a fresh id, nullptr if the id space is exhausted
+	Unit * Add(Unit && unit);
+	void Remove(UnitID id);
+
+	inline void Fork()
+	{
+		hot.Fork();
+		orders.Fork();
+		handles.Fork();
+	}
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_UNIT_STORE_H
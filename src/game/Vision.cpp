@@ -0,0 +1,102 @@
+
+#include "Vision.h"
+#include "Circle_Stencil.h"
+
+#include <algorithm>
+
+namespace Brushlink
+{
+
+Vision_Map::Vision_Map(int width, int height)
+	: counts(width, height, 0)
+	, visible(Area_Bits::Bounds({0, 0}, {width - 1, height - 1}))
+	, fog_mask(width, height, 0)
+{
+	std::fill(fog_mask.tiles.begin(), fog_mask.tiles.end(), 255);
+}
+
+void Vision_Map::AddCircle(Point center, float radius)
+{
+	Circle_Stencil::Get(radius).ForEachSpan(center, [&](int y, int x_min, int x_max)
+	{
+		AddSpan(y, x_min, x_max, 0, -1, 1);
+	});
+}
+
+void Vision_Map::RemoveCircle(Point center, float radius)
+{
+	Circle_Stencil::Get(radius).ForEachSpan(center, [&](int y, int x_min, int x_max)
+	{
+		AddSpan(y, x_min, x_max, 0, -1, -1);
+	});
+}
+
+void Vision_Map::MoveCircle(Point from, Point to, float radius)
+{
+	if (from == to)
+	{
+		return;
+	}
+	const Circle_Stencil & stencil = Circle_Stencil::Get(radius);
+	for (int dy = -stencil.bounds; dy <= stencil.bounds; dy++)
+	{
+		int y = from.y + dy;
+		int old_half = stencil.HalfWidth(dy);
+		int new_half = stencil.HalfWidth(y - to.y);
+		AddSpan(y, from.x - old_half, from.x + old_half,
+			to.x - new_half, to.x + new_half, -1);
+	}
+	for (int dy = -stencil.bounds; dy <= stencil.bounds; dy++)
+	{
+		int y = to.y + dy;
+		int new_half = stencil.HalfWidth(dy);
+		int old_half = stencil.HalfWidth(y - from.y);
+		AddSpan(y, to.x - new_half, to.x + new_half,
+			from.x - old_half, from.x + old_half, 1);
+	}
+}
+
+void Vision_Map::AddSpan(int y, int x_min, int x_max, int skip_min, int skip_max, int delta)
+{
+	if (y < 0 || y >= counts.height)
+	{
+		return;
+	}
+	x_min = std::max(x_min, 0);
+	x_max = std::min(x_max, counts.width - 1);
+	for (int x = x_min; x <= x_max; x++)
+	{
+		if (x >= skip_min && x <= skip_max)
+		{
+			// skip the overlap in one step
+			x = skip_max;
+			continue;
+		}
+		AddToTile({x, y}, delta);
+	}
+}
+
+void Vision_Map::AddToTile(Point p, int delta)
+{
+	uint16_t & count = counts.tiles[counts.Index(p)];
+	if (delta > 0)
+	{
+		if (count == 0)
+		{
+			visible.Insert(p);
+			fog_mask.tiles[fog_mask.Index(p)] = 0;
+		}
+		count += delta;
+	}
+	else
+	{
+		count += delta;
+		if (count == 0)
+		{
+			visible.Erase(p);
+			fog_mask.tiles[fog_mask.Index(p)] = 255;
+		}
+	}
+}
+
+} // namespace Brushlink
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef BRUSHLINK_VISION_H
+#define BRUSHLINK_VISION_H
+
+#include <cstdint>
+
+#include "Location.h"
+#include "Tile_Grid.h"
+#include "Area_Bits.h"
+
+namespace Brushlink
+{
+
+// persistent vision for one player
+// each tile counts how many of the player's units can see it
+// so units only add or remove their own circle when they spawn, move or die
+struct Vision_Map
+{
+	uint32_t owner = 0; // see Cow_Owner.h
+	Tile_Grid<uint16_t> counts;
+	Area_Bits visible; // tiles with a count above zero
+	// one byte per tile, 255 where fogged and 0 where visible
+	// out of bounds reads are 0 so the camera can pan past the edges
+	Tile_Grid<uint8_t> fog_mask;
+
+	Vision_Map() = default;
+
+	Vision_Map(int width, int height);
+
+	inline bool IsVisible(Point p) const
+	{
+		return counts.Get(p) > 0;
+	}
+
+	void AddCircle(Point center, float radius);
+	void RemoveCircle(Point center, float radius);
+	// only touches tiles that enter or leave the circle
+	void MoveCircle(Point from, Point to, float radius);
+
+	// helpers
+	// adds delta to the tiles in [x_min, x_max] that are not in [skip_min, skip_max]
+	void AddSpan(int y, int x_min, int x_max, int skip_min, int skip_max, int delta);
+	void AddToTile(Point p, int delta);
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_VISION_H
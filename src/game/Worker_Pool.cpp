@@ -0,0 +1,127 @@
+
+#include "Worker_Pool.h"
+
+#include <algorithm>
+
+namespace Brushlink
+{
+
+Worker_Pool::Worker_Pool(int thread_count)
+	: thread_count(thread_count)
+{ }
+
+Worker_Pool::~Worker_Pool()
+{
+	Stop();
+}
+
+int Worker_Pool::DefaultThreadCount()
+{
+	// hardware_concurrency is allowed to return 0 if it doesn't know
+	return std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+}
+
+void Worker_Pool::SetThreadCount(int thread_count)
+{
+	Stop();
+	this->thread_count = thread_count;
+}
+
+void Worker_Pool::StartThreads()
+{
+	int start_generation;
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		stopping = false;
+		start_generation = generation;
+	}
+	// the generation is read here rather than by the new thread
+	// otherwise a thread that first runs after Run bumps it
+	// would sleep through its loop and Run would wait on it forever
+	for (int i = 0; i < thread_count; i++)
+	{
+		threads.emplace_back([this, start_generation]() { WorkerLoop(start_generation); });
+	}
+}
+
+void Worker_Pool::Run(int count, int batch_size, const std::function<void(int)> & loop_body)
+{
+	if (threads.empty())
+	{
+		StartThreads();
+	}
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		body = &loop_body;
+		this->count = count;
+		this->batch_size = std::max(1, batch_size);
+		next_index = 0;
+		busy = threads.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	TakeBatches();
+
+	std::unique_lock<std::mutex> lock{mutex};
+	done.wait(lock, [this]() { return busy == 0; });
+	body = nullptr;
+}
+
+void Worker_Pool::TakeBatches()
+{
+	while (true)
+	{
+		int begin = next_index.fetch_add(batch_size);
+		if (begin >= count)
+		{
+			return;
+		}
+		int end = std::min(count, begin + batch_size);
+		for (int i = begin; i < end; i++)
+		{
+			(*body)(i);
+		}
+	}
+}
+
+void Worker_Pool::WorkerLoop(int seen_generation)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock{mutex};
+			wake.wait(lock, [&]() { return stopping || generation != seen_generation; });
+			if (stopping)
+			{
+				return;
+			}
+			seen_generation = generation;
+		}
+
+		TakeBatches();
+
+		std::lock_guard<std::mutex> lock{mutex};
+		busy--;
+		if (busy == 0)
+		{
+			done.notify_all();
+		}
+	}
+}
+
+void Worker_Pool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto & thread : threads)
+	{
+		thread.join();
+	}
+	threads.clear();
+}
+
+} // namespace Brushlink
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef BRUSHLINK_WORKER_POOL_H
+#define BRUSHLINK_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Brushlink
+{
+
+// a few long lived threads that split loops over many independent items
+// workers claim small batches of indices from a shared counter
+// so a thread that finishes early keeps taking work from the rest of the loop
+// the calling thread works too, and with no threads everything runs inline
+// threads are only started by the first loop big enough to split
+// so games and snapshots that never run one don't pay for them
+struct Worker_Pool
+{
+	int thread_count = 0;
+	std::vector<std::thread> threads; // empty until started
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	bool stopping = false;
+	int generation = 0; // bumped once per loop so sleeping workers know to start
+	int busy = 0; // workers still in the current loop
+
+	// the current loop
+	const std::function<void(int)> * body = nullptr;
+	int count = 0;
+	int batch_size = 1;
+	std::atomic<int> next_index{0};
+
+	Worker_Pool(int thread_count = DefaultThreadCount());
+	~Worker_Pool();
+
+	Worker_Pool(const Worker_Pool &) = delete;
+	Worker_Pool & operator=(const Worker_Pool &) = delete;
+
+	// one less than the hardware threads, the caller is the last one
+	static int DefaultThreadCount();
+
+	// stops any running threads, the new count starts on the next loop
+	void SetThreadCount(int thread_count);
+
+	// calls f(index) for every index in [0, count), in no particular order
+	// f must only write to state owned by its index
+	template<typename F>
+	void ParallelFor(int count, int batch_size, F && f)
+	{
+		if (thread_count == 0 || count <= batch_size)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				f(i);
+			}
+			return;
+		}
+		std::function<void(int)> loop_body{std::forward<F>(f)};
+		Run(count, batch_size, loop_body);
+	}
+
+	// helpers
+	void Run(int count, int batch_size, const std::function<void(int)> & loop_body);
+	void StartThreads();
+	void TakeBatches();
+	void WorkerLoop(int seen_generation);
+	void Stop();
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_WORKER_POOL_H
@@ -2,13 +2,21 @@
 #ifndef BRUSHLINK_WORLD_H
 #define BRUSHLINK_WORLD_H
 
+#include <array>
+
 #include "BuiltinTypedefs.h"
 #include "TigrExtensions.h"
 
 #include "Game_Basic_Types.h"
 #include "Unit.h"
+#include "Unit_Store.h"
 #include "Location.h"
+#include "Area_Bits.h"
+#include "Vision.h"
+#include "Spatial_Index.h"
+#include "Chunk_Map.h"
 #include "Player_Graphics.h"
+#include "State_Hash.h"
 
 
 namespace Brushlink
@@ -44,29 +52,109 @@ enum class Space_Occupation
 struct World
 {
 	World_Settings settings;
-	Area area;
-	std::shared_ptr<Tigr> drawn_terrain;
-	Map<UnitID, Unit> units; // intentionally an ordered map for traversal
-	Map<Point, UnitID> positions;
+	Chunk_Map chunks; // occupancy and terrain, no_unit for empty tiles
+	Spatial_Index spatial_index;
+	int render_frame = 0;
+	Unit_Store units;
+	// covers every unit, updated by the functions below
+	// so unit positions, energy and pending actions should only change through them
+	State_Hash hash;
+	// units whose energy changed since the last EnergyTick, may repeat
+	std::vector<UnitID> energy_changed;
 	// should world just have observer_ptr to the full Player?
 	Map<PlayerID, Player_Graphics > player_graphics;
+	// drawn once per graphics preference, indexed by Unit_Type
+	Map<Player_Graphics, std::array<std::shared_ptr<Tigr>, unit_type_count> > unit_bodies;
+	// copy on write, see Cow_Owner.h
+	Map<PlayerID, std::shared_ptr<Vision_Map> > vision;
+	uint32_t vision_owner = 0;
 
-	std::shared_ptr<Tigr> energy_bars{nullptr, TigrDeleter{}};
+	std::shared_ptr<Tigr> energy_bars;
 
 	World(const World_Settings & settings = World_Settings{});
 
+	// drawing is app only, see app/Render.cpp
 	void Render(Tigr* screen, Dimensions screen_space, Point camera_bottom_left, PlayerID player);
 
-	bool AddUnit(Unit && unit, Point position);
+	void RenderTerrain(Tigr* screen, Dimensions screen_space, Point camera_bottom_left);
+
+	void DrawChunkTerrain(World_Chunk & chunk);
+
+	void RenderFog(Tigr* screen, Dimensions screen_space, Point camera_bottom_left, const Vision_Map & vision);
+
+	// assigns the unit its id, nullptr if the position is taken or out of bounds
+	Unit * AddUnit(Unit && unit, Point position);
 
 	void RemoveUnit(UnitID id);
 
-	void RemoveUnits(Set<UnitID> ids);
+	void RemoveUnits(const std::vector<UnitID> & ids);
 
+	// copies the unit's page if it's shared with a snapshot, so only call it to write
 	Unit * GetUnit(UnitID id);
+	const Unit * GetUnit(UnitID id) const;
+
+	inline Unit_Orders & GetOrders(const Unit & unit)
+	{
+		return units.OrdersOf(unit);
+	}
+
+	inline const Unit_Orders & GetOrders(const Unit & unit) const
+	{
+		return units.OrdersOf(unit);
+	}
 
 	bool MoveUnit(UnitID id, Point destination);
 
+	void SetEnergy(Unit & unit, Energy energy);
+
+	inline void AddEnergy(Unit & unit, int amount)
+	{
+		SetEnergy(unit, Energy{unit.energy.value + amount});
+	}
+
+	void SetPending(Unit & unit, const Action_Step & pending);
+
+	// freezes the chunks, unit pages, spatial index and vision maps this world holds now
+	// so a copy of it can share them, see Cow_Owner.h
+	void Fork();
+
+	// from scratch, to check the incremental hash
+	State_Hash ComputeHash() const;
+
+	// all units leave their tiles before any enter, so chains and swaps work
+	// expects the moves to already be resolved to distinct, reachable destinations
+	void MoveUnits(const std::vector<std::pair<UnitID, Point> > & moves);
+
+	inline bool InBounds(Point p) const
+	{
+		return chunks.InBounds(p);
+	}
+
+	inline bool IsOccupied(Point p) const
+	{
+		return chunks.GetOccupant(p) != no_unit;
+	}
+
+	inline UnitID GetUnitIDAt(Point p) const
+	{
+		return chunks.GetOccupant(p);
+	}
+
+	inline int NeighborCount(Point p) const
+	{
+		return chunks.GetNeighborCount(p);
+	}
+
+	// for writing, creates the player's map if needed
+	Vision_Map & GetVision(PlayerID player);
+	// nullptr if the player has never had a unit
+	const Vision_Map * FindVision(PlayerID player) const;
+
+	bool IsVisible(PlayerID player, Point p) const;
+	// a spatial query filter that only finds other players' units where the player can see
+	// it points into the player's vision, so query before the world changes
+	Spatial_Filter SeenBy(PlayerID player, Player_Filter relation = Player_Filter::Any) const;
+
 };
 
 } // namespace Brushlink
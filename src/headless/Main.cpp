@@ -0,0 +1,263 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "Game.h"
+#include "Replay_Player.h"
+#include "Worker_Pool.h"
+#include "Scripted_Commands.h"
+
+using namespace Brushlink;
+
+// runs scripted games with no window as fast as the cores allow
+// usage: headless [games] [max_ticks] [threads] [results_file] [replay_folder] [hash_folder]
+//        headless play replay_file [seek_tick]
+//        headless compare hash_file hash_file
+// hash_folder records each game's state hash every tick, compare reports
+// the first tick and field two of those recordings differ in
+
+struct Game_Result
+{
+	int index = 0;
+	int ticks = 0;
+	PlayerID winner{-1}; // -1 if the game hit max_ticks or nobody was left
+	Map<PlayerID, int> unit_counts;
+	uint64_t state_hash = 0;
+	double seconds = 0.0;
+};
+
+void GiveScripts(Game & game)
+{
+	for (auto & [player_id, player] : game.players)
+	{
+		player.idle_command = value_ptr<Action_Command>{new Action_Skirmish{}};
+	}
+	// starting units were spawned before the players had scripts
+	for (Unit & unit : game.world.units)
+	{
+		game.world.GetOrders(unit).idle_command = value_ptr<Action_Command>{new Action_Skirmish{}};
+	}
+}
+
+Game_Result RunGame(
+	int index,
+	int max_ticks,
+	std::shared_ptr<const Ruleset> rules,
+	const std::string & replay_folder,
+	const std::string & hash_folder)
+{
+	auto start = std::chrono::steady_clock::now();
+	Game_Result result;
+	result.index = index;
+
+	// seeded through settings so the seed is saved and recorded with the game
+	GameSettings settings = GameSettings::default_settings;
+	settings.seed = index;
+	for (auto & [player_id, player_settings] : settings.player_settings)
+	{
+		player_settings.type = Player_Type::AI;
+	}
+	Game game{rules, settings};
+	// games already run one per core
+	game.workers.SetThreadCount(0);
+	game.Initialize();
+	GiveScripts(game);
+	if (!replay_folder.empty())
+	{
+		game.RecordReplay();
+	}
+	if (!hash_folder.empty())
+	{
+		game.hash_recorder.reset(new Hash_Recorder{});
+	}
+
+	while (game.tick.value < max_ticks && !game.IsOver())
+	{
+		game.Tick();
+	}
+
+	result.ticks = game.tick.value;
+	for (Unit & unit : game.world.units)
+	{
+		result.unit_counts[unit.player] += 1;
+	}
+	if (game.IsOver() && result.unit_counts.size() == 1)
+	{
+		result.winner = result.unit_counts.begin()->first;
+	}
+	result.state_hash = game.GetStateHash().Combined();
+	if (game.replay_recorder)
+	{
+		auto saved = game.replay_recorder->replay.Save(
+			replay_folder + "/game_" + std::to_string(index) + ".replay");
+		if (saved.IsError())
+		{
+			saved.GetError().Log();
+		}
+	}
+	if (game.hash_recorder)
+	{
+		auto saved = game.hash_recorder->Save(
+			hash_folder + "/game_" + std::to_string(index) + ".hashes");
+		if (saved.IsError())
+		{
+			saved.GetError().Log();
+		}
+	}
+	result.seconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+int CompareHashes(const std::string & file_a, const std::string & file_b)
+{
+	auto a = Hash_Recorder::Load(file_a);
+	auto b = Hash_Recorder::Load(file_b);
+	if (a.IsError())
+	{
+		a.GetError().Log();
+		return 1;
+	}
+	if (b.IsError())
+	{
+		b.GetError().Log();
+		return 1;
+	}
+	auto desync = a.GetValue().FindDesync(b.GetValue());
+	if (!desync)
+	{
+		std::cout << "no desync in "
+			<< std::min(a.GetValue().stream.size(), b.GetValue().stream.size())
+			<< " ticks" << std::endl;
+		return 0;
+	}
+	if (!desync->field)
+	{
+		std::cout << "recorded different ticks from tick " << desync->tick.value << std::endl;
+	}
+	else
+	{
+		std::cout << "first desync at tick " << desync->tick.value
+			<< " in " << GetName(*desync->field) << std::endl;
+	}
+	return 1;
+}
+
+int PlayReplay(const std::string & file_name, int seek_tick)
+{
+	auto loaded = Replay::Load(file_name);
+	if (loaded.IsError())
+	{
+		loaded.GetError().Log();
+		return 1;
+	}
+	auto replay = std::make_shared<const Replay>(loaded.GetValue());
+	auto start = std::chrono::steady_clock::now();
+	Replay_Player player{replay, GiveScripts};
+	auto played = player.BuildKeyframes();
+	if (played.IsError())
+	{
+		played.GetError().Log();
+		return 1;
+	}
+	double play_seconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+	std::cout << replay->length.value << " ticks played in " << play_seconds << "s, "
+		<< replay->keyframes.size() << " keyframes, final state hash "
+		<< std::hex << player.game->GetStateHash().Combined() << std::dec << std::endl;
+	if (seek_tick >= 0)
+	{
+		// a fresh player, so the seek starts from a keyframe loaded from the file
+		Replay_Player seeker{replay, GiveScripts};
+		start = std::chrono::steady_clock::now();
+		auto sought = seeker.Seek(Ticks{seek_tick});
+		if (sought.IsError())
+		{
+			sought.GetError().Log();
+			return 1;
+		}
+		double seek_seconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+		std::cout << "seeked to tick " << seeker.game->tick.value << " in " << seek_seconds << "s, "
+			<< seeker.game->world.units.Count() << " units" << std::endl;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc > 2 && std::string{argv[1]} == "play")
+	{
+		return PlayReplay(argv[2], argc > 3 ? std::atoi(argv[3]) : -1);
+	}
+	if (argc > 3 && std::string{argv[1]} == "compare")
+	{
+		return CompareHashes(argv[2], argv[3]);
+	}
+	int game_count = argc > 1 ? std::atoi(argv[1]) : 64;
+	int max_ticks = argc > 2 ? std::atoi(argv[2]) : 12 * 60 * 10;
+	int thread_count = argc > 3 ? std::atoi(argv[3]) : Worker_Pool::DefaultThreadCount();
+	std::string results_file = argc > 4 ? argv[4] : "headless_results.csv";
+	std::string replay_folder = argc > 5 ? argv[5] : "";
+	std::string hash_folder = argc > 6 ? argv[6] : "";
+
+	// every game shares one compiled copy of the rules
+	auto rules = Ruleset::Compile(GameSettings::default_settings);
+
+	std::vector<Game_Result> results(game_count);
+	auto start = std::chrono::steady_clock::now();
+	Worker_Pool pool{thread_count};
+	pool.ParallelFor(game_count, 1, [&](int index)
+	{
+		results[index] = RunGame(index, max_ticks, rules, replay_folder, hash_folder);
+	});
+	double seconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+
+	FILE * file = fopen(results_file.c_str(), "w");
+	if (file == nullptr)
+	{
+		Error("Couldn't open results file " + results_file).Log();
+		return 1;
+	}
+	fprintf(file, "game,ticks,winner,units_0,units_1,state_hash,seconds\n");
+	long long total_ticks = 0;
+	int unfinished = 0;
+	Map<PlayerID, int> wins;
+	for (auto & result : results)
+	{
+		total_ticks += result.ticks;
+		if (result.winner.value == -1)
+		{
+			unfinished++;
+		}
+		else
+		{
+			wins[result.winner] += 1;
+		}
+		fprintf(file, "%d,%d,%d,%d,%d,%016llx,%f\n",
+			result.index,
+			result.ticks,
+			result.winner.value,
+			result.unit_counts[PlayerID{0}],
+			result.unit_counts[PlayerID{1}],
+			static_cast<unsigned long long>(result.state_hash),
+			result.seconds);
+	}
+	fclose(file);
+
+	std::cout << game_count << " games, "
+		<< total_ticks << " ticks in "
+		<< seconds << "s ("
+		<< (seconds > 0.0 ? total_ticks / seconds : 0.0) << " ticks/s)" << std::endl;
+	for (auto & [player, count] : wins)
+	{
+		std::cout << "player " << player.value << " won " << count << std::endl;
+	}
+	std::cout << unfinished << " games unfinished or drawn" << std::endl;
+	std::cout << "results written to " << results_file << std::endl;
+	return 0;
+}
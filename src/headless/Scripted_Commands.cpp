@@ -0,0 +1,95 @@
+
+#include "Scripted_Commands.h"
+#include "Context.h"
+#include "Game.h"
+
+namespace Brushlink
+{
+
+// stateless, so there is nothing to read back
+[[maybe_unused]] static bool skirmish_registered = RegisterActionCommand("Skirmish", [](Byte_Reader &) -> Action_Command *
+{
+	return new Action_Skirmish{};
+});
+
+Action_Step Action_Skirmish::Evaluate(const Command_View & view, const Unit & unit) const
+{
+	const World & world = view.game.world;
+	const Unit_Rules & rules = *unit.type;
+
+	// at the map edge some of the 8 neighbors don't exist, so count only the
+	// ones that do, otherwise a unit there keeps trying to reproduce when full
+	int neighbor_tiles = 0;
+	for (auto & neighbor_position : unit.position.GetNeighbors())
+	{
+		if (world.InBounds(neighbor_position))
+		{
+			neighbor_tiles++;
+		}
+	}
+	const Action_Rules & reproduce = rules.Action(Action_Type::Reproduce);
+	if (reproduce.available
+		&& unit.energy.value >= reproduce.cost.value
+		&& world.NeighborCount(unit.position) < neighbor_tiles)
+	{
+		return {Action_Type::Reproduce, {}, {}};
+	}
+
+	if (rules.Action(Action_Type::Heal).available)
+	{
+		for (auto & neighbor_position : unit.position.GetNeighbors())
+		{
+			const Unit * neighbor = world.GetUnit(world.GetUnitIDAt(neighbor_position));
+			if (neighbor != nullptr
+				&& neighbor->player == unit.player
+				&& neighbor->energy.value < neighbor->type->max_energy.value)
+			{
+				return {Action_Type::Heal, {}, {neighbor->id}};
+			}
+		}
+	}
+
+	std::vector<UnitID> nearest = world.spatial_index.Nearest(
+		unit.position,
+		1,
+		Spatial_Filter{Player_Filter::Not_Owned_By, unit.player});
+	if (nearest.empty())
+	{
+		return {Action_Type::Idle, {}, {}};
+	}
+	const Unit * enemy = world.GetUnit(nearest.front());
+	if (unit.position.IsNeighbor(enemy->position))
+	{
+		if (rules.Action(Action_Type::Attack).available)
+		{
+			return {Action_Type::Attack, {}, {enemy->id}};
+		}
+		return {Action_Type::Idle, {}, {}};
+	}
+
+	if (!rules.Action(Action_Type::Move).available)
+	{
+		return {Action_Type::Idle, {}, {}};
+	}
+	// step along whichever axis is further from the enemy, preferring empty tiles
+	Point best = unit.position;
+	int best_distance = enemy->position.CardinalDistance(unit.position);
+	for (auto & step : unit.position.GetCardinalNeighbors())
+	{
+		int distance = enemy->position.CardinalDistance(step);
+		if (distance < best_distance
+			&& world.InBounds(step)
+			&& !world.IsOccupied(step))
+		{
+			best = step;
+			best_distance = distance;
+		}
+	}
+	if (best == unit.position)
+	{
+		return {Action_Type::Idle, {}, {}};
+	}
+	return {Action_Type::Move, {best}, {}};
+}
+
+} // namespace Brushlink
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef BRUSHLINK_SCRIPTED_COMMANDS_H
+#define BRUSHLINK_SCRIPTED_COMMANDS_H
+
+#include "Command.h"
+#include "Unit.h"
+
+namespace Brushlink
+{
+
+// fixed behavior for headless players, used as every unit's idle command
+// spawners reproduce whenever they can afford it
+// healers top up hurt neighbors, attackers hit adjacent enemies
+// and everyone else walks toward the nearest enemy
+struct Action_Skirmish : Action_Command
+{
+	Action_Step Evaluate(const Command_View & view, const Unit & unit) const override;
+
+	Action_Command * clone() const override
+	{
+		return new Action_Skirmish{*this};
+	}
+
+	const char * SaveName() const override { return "Skirmish"; }
+};
+
+} // namespace Brushlink
+
+#endif // BRUSHLINK_SCRIPTED_COMMANDS_H
@@ -0,0 +1,117 @@
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include <sys/resource.h>
+
+#include "./benchmark/Scenarios.hpp"
+
+/*
+make build/bin/benchmarks && ./build/bin/benchmarks [scenario_name] > results.jsonl
+one JSON object per line per scenario
+*/
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+long PeakMemoryKilobytes()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	// bytes on macOS, kilobytes on linux
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+}
+
+void RunScenario(const Benchmark_Scenario & scenario, std::shared_ptr<const Ruleset> rules)
+{
+	GameSettings settings = GameSettings::default_settings;
+	settings.starting_units.clear();
+	settings.world_settings.width = scenario.width;
+	settings.world_settings.height = scenario.height;
+	for (auto & [player_id, player_settings] : settings.player_settings)
+	{
+		player_settings.type = Player_Type::AI;
+	}
+
+	Game game{rules, settings};
+	game.Initialize();
+	for (auto & [player_id, player] : game.players)
+	{
+		player.idle_command = value_ptr<Action_Command>{new Action_Skirmish{}};
+	}
+
+	auto setup_start = Clock::now();
+	scenario.populate(game);
+	double setup_seconds = SecondsSince(setup_start);
+	int starting_units = game.world.units.Count();
+
+	// the real Tick, phases are read back from the game's profiler
+	// setup may already have timed some phases, so only the difference counts
+	std::array<double, profile_phase_count> setup_us{};
+	for (int phase = 0; phase < profile_phase_count; phase++)
+	{
+		setup_us[phase] = game.profiler.Compute(static_cast<Profile_Phase>(phase)).total_us;
+	}
+	auto run_start = Clock::now();
+	for (int i = 0; i < scenario.ticks; i++)
+	{
+		game.Tick();
+	}
+	double run_seconds = SecondsSince(run_start);
+
+	printf("{\"scenario\":\"%s\",\"width\":%d,\"height\":%d,\"ticks\":%d,"
+		"\"starting_units\":%d,\"ending_units\":%d,"
+		"\"setup_s\":%.6f,\"run_s\":%.6f,\"ticks_per_second\":%.2f,",
+		scenario.name.c_str(),
+		scenario.width,
+		scenario.height,
+		scenario.ticks,
+		starting_units,
+		game.world.units.Count(),
+		setup_seconds,
+		run_seconds,
+		run_seconds > 0.0 ? scenario.ticks / run_seconds : 0.0);
+	// mean per tick, so phases run more or less than once a tick stay comparable with Tick
+	for (int phase = 0; phase < profile_phase_count; phase++)
+	{
+		if (static_cast<Profile_Phase>(phase) == Profile_Phase::Render)
+		{
+			continue;
+		}
+		double phase_us = game.profiler.Compute(static_cast<Profile_Phase>(phase)).total_us
+			- setup_us[phase];
+		printf("\"%s_us\":%.3f,",
+			GetName(static_cast<Profile_Phase>(phase)),
+			phase_us / scenario.ticks);
+	}
+	printf("\"peak_memory_kb\":%ld,\"state_hash\":\"%016llx\"}\n",
+		// process wide, so scenarios run smallest first
+		PeakMemoryKilobytes(),
+		static_cast<unsigned long long>(game.GetStateHash().Combined()));
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	std::string only = argc > 1 ? argv[1] : "";
+	auto rules = Ruleset::Compile(GameSettings::default_settings);
+	for (auto & scenario : GetBenchmarkScenarios())
+	{
+		if (!only.empty() && scenario.name != only)
+		{
+			continue;
+		}
+		RunScenario(scenario, rules);
+	}
+	return 0;
+}
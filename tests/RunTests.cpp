@@ -4,6 +4,14 @@
 // #include "./command/TestASTParsing.hpp"
 #include "./command/InteractiveTestNextTokens.hpp"
 #include "./command/InteractiveTestCommandCard.hpp"
+#include "./command/TestSpatialBuiltins.hpp"
+#include "./game/TestResolveIntents.hpp"
+#include "./game/TestAreaBits.hpp"
+#include "./game/TestUnitStore.hpp"
+#include "./game/TestSaveLoad.hpp"
+#include "./game/TestHashRecorder.hpp"
+#include "./game/TestUnitReferences.hpp"
+#include "./game/TestReplay.hpp"
 
 /*
 g++ -std=c++17 -Wfatal-errors -I../farb/src/core -I../farb/src/interface -I../farb/src/reflection -I../farb/src/serialization -I../farb/src/utils tests/RunTests.cpp ../farb/build/link/farb.a -g && ./a.out;
@@ -16,7 +24,15 @@ int main(void)
 	
 	bool success = Run<
 		InteractiveTestNextTokens,
-		InteractiveTestCommandCard>(true);
+		InteractiveTestCommandCard,
+		TestSpatialBuiltins,
+		TestResolveIntents,
+		TestAreaBits,
+		TestUnitStore,
+		TestSaveLoad,
+		TestHashRecorder,
+		TestUnitReferences,
+		TestReplay>(true);
 	
 	std::cout << "All Tests Passed" << std::endl;
 	if (success) return 0;
@@ -0,0 +1,101 @@
+#ifndef BENCHMARK_SCENARIOS_HPP
+#define BENCHMARK_SCENARIOS_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../../src/game/Game.h"
+#include "../../src/headless/Scripted_Commands.h"
+
+using namespace Brushlink;
+
+// every scenario places its units the same way on every run
+// so numbers from different builds are comparable
+struct Benchmark_Scenario
+{
+	std::string name;
+	int width;
+	int height;
+	int ticks;
+	// called once the game is initialized, spawns the scenario's units
+	std::function<void(Game &)> populate;
+};
+
+inline Unit_Type MixedUnitType(int index)
+{
+	// mostly attackers, some healers, a few spawners
+	switch (index % 8)
+	{
+	case 0:
+		return Unit_Type::Spawner;
+	case 1:
+	case 2:
+		return Unit_Type::Healer;
+	default:
+		return Unit_Type::Attacker;
+	}
+}
+
+// a filled square of units per player, facing each other across the middle
+inline void PopulateBlobs(Game & game, int side)
+{
+	int center_y = game.world.settings.height / 2;
+	int left = game.world.settings.width / 2 - side - 2;
+	int right = game.world.settings.width / 2 + 2;
+	int index = 0;
+	for (int y = center_y - side / 2; y < center_y - side / 2 + side; y++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			game.SpawnUnit(PlayerID{0}, MixedUnitType(index), Point{left + x, y});
+			game.SpawnUnit(PlayerID{1}, MixedUnitType(index), Point{right + x, y});
+			index++;
+		}
+	}
+}
+
+// units per player on a sparse lattice over their half of the map
+inline void PopulateSpread(Game & game, int units_per_player, int spacing)
+{
+	int half = game.world.settings.width / 2;
+	int columns = std::max(1, half / spacing);
+	for (int i = 0; i < units_per_player; i++)
+	{
+		int x = (i % columns) * spacing;
+		int y = (i / columns) * spacing;
+		game.SpawnUnit(PlayerID{0}, MixedUnitType(i), Point{x, y});
+		game.SpawnUnit(PlayerID{1}, MixedUnitType(i), Point{half + x, y});
+	}
+}
+
+// a handful of spawners per player with lots of room to fill
+inline void PopulateSpawners(Game & game, int per_player)
+{
+	for (int i = 0; i < per_player; i++)
+	{
+		int y = 8 + i * 8;
+		game.SpawnUnit(PlayerID{0}, Unit_Type::Spawner, Point{8, y});
+		game.SpawnUnit(PlayerID{1}, Unit_Type::Spawner, Point{game.world.settings.width - 9, y});
+	}
+}
+
+inline std::vector<Benchmark_Scenario> GetBenchmarkScenarios()
+{
+	return {
+		{"dense_blobs_1k", 128, 128, 400,
+			[](Game & game) { PopulateBlobs(game, 22); }},
+		{"spread_armies_1k", 256, 256, 400,
+			[](Game & game) { PopulateSpread(game, 500, 4); }},
+		{"heavy_reproduction", 256, 256, 1200,
+			[](Game & game) { PopulateSpawners(game, 16); }},
+		{"units_1k", 128, 128, 400,
+			[](Game & game) { PopulateSpread(game, 500, 2); }},
+		{"units_10k", 512, 512, 200,
+			[](Game & game) { PopulateSpread(game, 5000, 2); }},
+		{"units_100k", 1024, 1024, 50,
+			[](Game & game) { PopulateSpread(game, 50000, 2); }},
+	};
+}
+
+#endif // BENCHMARK_SCENARIOS_HPP
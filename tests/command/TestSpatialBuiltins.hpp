@@ -0,0 +1,96 @@
+#ifndef TEST_SPATIAL_BUILTINS_HPP
+#define TEST_SPATIAL_BUILTINS_HPP
+
+#include <assert.h>
+
+#include "../../../farb/tests/RegisterTest.hpp"
+#include "../../src/command/Context.h"
+#include "../../src/game/Game.h"
+
+using namespace Farb;
+
+using namespace Farb::Tests;
+
+using namespace Brushlink;
+
+class TestSpatialBuiltins : public ITest
+{
+public:
+	virtual bool RunTests() const override
+	{
+		std::cout << "Spatial Builtins" << std::endl;
+
+		// one unit of our own, an enemy it can see and an enemy in fog
+		GameSettings settings = GameSettings::default_settings;
+		settings.world_settings.width = 64;
+		settings.world_settings.height = 64;
+		settings.world_settings.starting_locations = {{5, 5}, {50, 50}};
+		settings.starting_units.clear();
+		Game game{settings};
+		game.Initialize();
+		auto Place = [&](PlayerID player, Point position)
+		{
+			auto result = game.SpawnUnit(player, Unit_Type::Attacker, position);
+			assert(!result.IsError());
+			return result.GetValue();
+		};
+		UnitID own = Place(PlayerID{0}, {10, 10});
+		UnitID seen = Place(PlayerID{1}, {12, 10});
+		UnitID fogged = Place(PlayerID{1}, {30, 10});
+		assert(!game.world.IsVisible(PlayerID{0}, {30, 10}));
+
+		Command::Context & context = game.players.at(PlayerID{0}).root_command_context;
+		auto Finds = [](ErrorOr<Unit_Group> result, std::vector<UnitID> expected)
+		{
+			if (result.IsError()
+				|| result.GetValue().members.size() != expected.size())
+			{
+				return false;
+			}
+			for (auto id : expected)
+			{
+				if (result.GetValue().members.count(id) == 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		{
+			bool success = Finds(context.GetNearestEnemies({10, 10}, Number{2}), {seen});
+			farb_print(success, "nearest enemies skips an enemy in fog");
+			assert(success);
+		}
+
+		{
+			bool success = Finds(context.GetEnemiesWithinRange({10, 10}, Number{30}), {seen});
+			farb_print(success, "enemies within range skips an enemy in fog");
+			assert(success);
+		}
+
+		{
+			bool success = Finds(context.GetUnitsWithinRange({10, 10}, Number{30}), {own, seen});
+			farb_print(success, "units within range skips an enemy in fog");
+			assert(success);
+		}
+
+		{
+			bool success = Finds(context.GetUnitsInBox({0, 0}, {40, 40}), {own, seen});
+			farb_print(success, "units in box skips an enemy in fog");
+			assert(success);
+		}
+
+		{
+			// an enemy is found once it's seen
+			Place(PlayerID{0}, {29, 10});
+			bool success = Finds(context.GetNearestEnemies({10, 10}, Number{2}), {seen, fogged});
+			farb_print(success, "nearest enemies finds an enemy once it's seen");
+			assert(success);
+		}
+
+		return true;
+	}
+};
+
+#endif // TEST_SPATIAL_BUILTINS_HPP
@@ -0,0 +1,135 @@
+#ifndef TEST_AREA_BITS_HPP
+#define TEST_AREA_BITS_HPP
+
+#include <assert.h>
+
+#include "../../../farb/tests/RegisterTest.hpp"
+#include "../../src/game/Area_Bits.h"
+
+using namespace Farb;
+
+using namespace Farb::Tests;
+
+using namespace Brushlink;
+
+bool SamePoints(const Area & a, const Area & b)
+{
+	if (a.points.size() != b.points.size())
+	{
+		return false;
+	}
+	for (auto & point : a.points)
+	{
+		if (b.points.count(point) == 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// the sparse reference for the set operations Area doesn't have
+Area Intersection(const Area & a, const Area & b)
+{
+	Area result;
+	for (auto & point : a.points)
+	{
+		if (b.points.count(point) != 0)
+		{
+			result.points.insert(point);
+		}
+	}
+	return result;
+}
+
+Area Difference(const Area & a, const Area & b)
+{
+	Area result;
+	for (auto & point : a.points)
+	{
+		if (b.points.count(point) == 0)
+		{
+			result.points.insert(point);
+		}
+	}
+	return result;
+}
+
+class TestAreaBits : public ITest
+{
+public:
+	virtual bool RunTests() const override
+	{
+		std::cout << "Area Bits" << std::endl;
+
+		// circles straddling word columns and negative coordinates
+		std::vector<std::pair<Point, float> > circles{
+			{{0, 0}, 4.5},
+			{{63, 5}, 3.0},
+			{{-2, -70}, 6.5},
+			{{130, 64}, 10.0},
+			{{60, 2}, 7.5},
+		};
+
+		for (auto & [center, radius] : circles)
+		{
+			Area area = Area::Circle(center, radius);
+			Area_Bits bits = Area_Bits::Circle(center, radius);
+			bool success = SamePoints(bits.ToArea(), area)
+				&& SamePoints(Area_Bits::FromArea(area).ToArea(), area)
+				&& bits.Count() == static_cast<int>(area.points.size());
+			farb_print(success, "circle at " + std::to_string(center.x) + ", " + std::to_string(center.y));
+			assert(success);
+		}
+
+		for (std::size_t i = 0; i < circles.size(); i++)
+		{
+			for (std::size_t j = 0; j < circles.size(); j++)
+			{
+				Area a = Area::Circle(circles[i].first, circles[i].second);
+				Area b = Area::Circle(circles[j].first, circles[j].second);
+				Area_Bits a_bits = Area_Bits::FromArea(a);
+				Area_Bits b_bits = Area_Bits::FromArea(b);
+
+				Area union_area = a;
+				union_area.UnionWith(b);
+				Area_Bits union_bits = a_bits;
+				union_bits.UnionWith(b_bits);
+
+				Area_Bits intersection_bits = a_bits;
+				intersection_bits.IntersectWith(b_bits);
+
+				Area_Bits difference_bits = a_bits;
+				difference_bits.DifferenceWith(b_bits);
+
+				bool success = SamePoints(union_bits.ToArea(), union_area)
+					&& SamePoints(intersection_bits.ToArea(), Intersection(a, b))
+					&& SamePoints(difference_bits.ToArea(), Difference(a, b));
+				farb_print(success, "set operations on circles " + std::to_string(i) + " and " + std::to_string(j));
+				assert(success);
+			}
+		}
+
+		{
+			Area_Bits bits;
+			bits.Insert({-1, 3});
+			bits.Insert({64, 3});
+			bits.InsertSpan(4, 60, 70);
+			bits.Erase({65, 4});
+			bool success = bits.Contains({-1, 3})
+				&& bits.Contains({64, 3})
+				&& !bits.Contains({0, 3})
+				&& bits.Contains({63, 4})
+				&& !bits.Contains({65, 4})
+				&& bits.Count() == 12;
+			bits.Clear();
+			success = success && bits.IsEmpty();
+			farb_print(success, "insert, erase and spans across words");
+			assert(success);
+		}
+
+		return true;
+	}
+};
+
+#endif // TEST_AREA_BITS_HPP
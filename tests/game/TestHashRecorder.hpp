@@ -0,0 +1,88 @@
+#ifndef TEST_HASH_RECORDER_HPP
+#define TEST_HASH_RECORDER_HPP
+
+#include <assert.h>
+
+#include "../../../farb/tests/RegisterTest.hpp"
+#include "../../src/game/Game.h"
+
+using namespace Farb;
+
+using namespace Farb::Tests;
+
+using namespace Brushlink;
+
+std::unique_ptr<Game> MakeRecordedGame()
+{
+	GameSettings settings = GameSettings::default_settings;
+	settings.seed = 5;
+	auto game = std::make_unique<Game>(settings);
+	game->Initialize();
+	game->hash_recorder.reset(new Hash_Recorder{});
+	return game;
+}
+
+class TestHashRecorder : public ITest
+{
+public:
+	virtual bool RunTests() const override
+	{
+		std::cout << "Hash Recorder" << std::endl;
+
+		{
+			auto a = MakeRecordedGame();
+			auto b = MakeRecordedGame();
+			for (int i = 0; i < 30; i++)
+			{
+				a->Tick();
+				b->Tick();
+			}
+			bool success = !a->hash_recorder->FindDesync(*b->hash_recorder);
+			farb_print(success, "identical games don't desync");
+			assert(success);
+
+			// the spawner starts well below its max energy, so one more won't be clamped
+			for (Unit & unit : b->world.units)
+			{
+				if (unit.type->type == Unit_Type::Spawner)
+				{
+					b->world.AddEnergy(unit, 1);
+					break;
+				}
+			}
+			Ticks changed_after = b->tick;
+			for (int i = 0; i < 30; i++)
+			{
+				a->Tick();
+				b->Tick();
+			}
+			auto desync = a->hash_recorder->FindDesync(*b->hash_recorder);
+			success = desync
+				&& desync->tick.value == changed_after.value + 1
+				&& desync->field == Hash_Field::Energy;
+			farb_print(success, "a changed energy is reported at the next tick in the energy field");
+			assert(success);
+		}
+
+		{
+			// with a tick missing from one stream the fields aren't compared
+			auto a = MakeRecordedGame();
+			for (int i = 0; i < 5; i++)
+			{
+				a->Tick();
+			}
+			Hash_Recorder skipped = *a->hash_recorder;
+			skipped.stream.erase(skipped.stream.begin() + 2);
+			auto desync = a->hash_recorder->FindDesync(skipped);
+			bool success = desync
+				&& desync->tick == a->hash_recorder->stream[2].tick
+				&& !desync->field;
+			farb_print(success, "streams with different ticks report the tick without a field");
+			assert(success);
+		}
+
+		return true;
+	}
+};
+
+#endif // TEST_HASH_RECORDER_HPP
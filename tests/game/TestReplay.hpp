@@ -0,0 +1,134 @@
+#ifndef TEST_REPLAY_HPP
+#define TEST_REPLAY_HPP
+
+#include <assert.h>
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "../../../farb/tests/RegisterTest.hpp"
+#include "../../src/game/Game.h"
+#include "../../src/game/Replay_Player.h"
+
+using namespace Farb;
+
+using namespace Farb::Tests;
+
+using namespace Brushlink;
+
+// moves every unit player 0 has to the destination
+Issued_Command MoveAll(const Game & game, Point destination)
+{
+	Issued_Command move{PlayerID{0}, Issued_Command_Type::Move, {}, destination};
+	for (const Unit & unit : game.world.units)
+	{
+		if (unit.player == move.player)
+		{
+			move.actors.push_back(unit.id);
+		}
+	}
+	std::sort(move.actors.begin(), move.actors.end(), [](UnitID a, UnitID b)
+	{
+		return a.value < b.value;
+	});
+	return move;
+}
+
+class TestReplay : public ITest
+{
+public:
+	virtual bool RunTests() const override
+	{
+		std::cout << "Replay" << std::endl;
+
+		GameSettings settings = GameSettings::default_settings;
+		settings.world_settings.width = 64;
+		settings.world_settings.height = 64;
+		settings.world_settings.starting_locations = {{10, 10}, {50, 50}};
+		settings.seed = 7;
+		Game game{settings};
+		game.Initialize();
+		game.RecordReplay(50);
+
+		// the live game's hash after every tick, by tick
+		std::vector<uint64_t> hashes{game.GetStateHash().Combined()};
+		std::vector<Point> destinations{{40, 30}, {20, 45}, {35, 15}};
+		for (int i = 0; i < 300; i++)
+		{
+			if (i % 100 == 20)
+			{
+				game.Issue(MoveAll(std::as_const(game), destinations[i / 100]));
+			}
+			game.Tick();
+			hashes.push_back(game.GetStateHash().Combined());
+		}
+		const Replay & recorded = game.replay_recorder->replay;
+
+		{
+			bool success = !recorded.keyframes.empty();
+			for (auto & keyframe : recorded.keyframes)
+			{
+				success = success && !keyframe.state.empty();
+			}
+			success = success && recorded.keyframes.back().state.size() < game.SaveState().size();
+			farb_print(success, "keyframes have state, smaller than a full save");
+			assert(success);
+		}
+
+		const std::string file_name = "test_replay.blrp";
+		auto saved = recorded.Save(file_name);
+		assert(!saved.IsError());
+		auto loaded = Replay::Load(file_name);
+		std::remove(file_name.c_str());
+		assert(!loaded.IsError());
+		auto replay = std::make_shared<const Replay>(std::move(loaded.GetValue()));
+
+		{
+			bool success = replay->length == game.tick
+				&& replay->keyframes.size() == recorded.keyframes.size();
+			farb_print(success, "a saved replay loads with its length and keyframes");
+			assert(success);
+		}
+
+		Replay_Player player{replay};
+		{
+			auto played = player.BuildKeyframes();
+			bool success = !played.IsError()
+				&& player.game->tick == game.tick
+				&& player.game->GetStateHash() == game.GetStateHash();
+			farb_print(success, "playback ends with the live game's hash");
+			assert(success);
+		}
+
+		auto SeeksTo = [&](Replay_Player & seeking, int target)
+		{
+			auto sought = seeking.Seek(Ticks{target});
+			return !sought.IsError()
+				&& seeking.game->tick.value == target
+				&& seeking.game->GetStateHash().Combined() == hashes[target];
+		};
+
+		{
+			bool success = SeeksTo(player, 120)
+				&& SeeksTo(player, 30)
+				&& SeeksTo(player, 275)
+				&& SeeksTo(player, 150);
+			farb_print(success, "seeking back and forward matches straight playback");
+			assert(success);
+		}
+
+		{
+			// nothing played yet, so these start from the keyframes' saved state
+			Replay_Player fresh{replay};
+			bool success = SeeksTo(fresh, 275)
+				&& SeeksTo(fresh, 100)
+				&& SeeksTo(fresh, 210);
+			farb_print(success, "seeking from loaded keyframes matches straight playback");
+			assert(success);
+		}
+
+		return true;
+	}
+};
+
+#endif // TEST_REPLAY_HPP
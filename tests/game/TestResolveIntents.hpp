@@ -0,0 +1,170 @@
+#ifndef TEST_RESOLVE_INTENTS_HPP
+#define TEST_RESOLVE_INTENTS_HPP
+
+#include <assert.h>
+
+#include "../../../farb/tests/RegisterTest.hpp"
+#include "../../src/game/Game.h"
+
+using namespace Farb;
+
+using namespace Farb::Tests;
+
+using namespace Brushlink;
+
+// an empty map with rules compiled, units are placed by hand
+std::unique_ptr<Game> MakeEmptyGame()
+{
+	GameSettings settings = GameSettings::default_settings;
+	settings.player_settings.clear();
+	settings.starting_units.clear();
+	auto game = std::make_unique<Game>(settings);
+	game->Initialize();
+	return game;
+}
+
+UnitID PlaceUnit(Game & game, Point position)
+{
+	auto result = game.SpawnUnit(PlayerID{0}, Unit_Type::Attacker, position);
+	assert(!result.IsError());
+	return result.GetValue();
+}
+
+Action_Intent MoveIntent(UnitID unit, Point destination)
+{
+	Action_Intent intent;
+	intent.unit = unit;
+	intent.type = Action_Type::Move;
+	intent.destination = destination;
+	return intent;
+}
+
+bool IsAt(Game & game, UnitID unit, Point position)
+{
+	return game.world.GetUnit(unit)->position == position
+		&& game.world.GetUnitIDAt(position) == unit;
+}
+
+class TestResolveIntents : public ITest
+{
+public:
+	virtual bool RunTests() const override
+	{
+		std::cout << "Resolve Intents" << std::endl;
+
+		{
+			// the lowest id wins a contested tile, the other keeps waiting
+			auto game = MakeEmptyGame();
+			UnitID a = PlaceUnit(*game, {10, 10});
+			UnitID b = PlaceUnit(*game, {12, 10});
+			std::vector<Action_Intent> intents{
+				MoveIntent(a, {11, 10}),
+				MoveIntent(b, {11, 10}),
+			};
+			game->ResolveIntents(intents);
+			bool success = intents[0].result == Action_Result::Success
+				&& intents[1].result == Action_Result::Retry
+				&& IsAt(*game, a, {11, 10})
+				&& IsAt(*game, b, {12, 10});
+			farb_print(success, "two units claiming one tile");
+			assert(success);
+		}
+
+		{
+			// a move into a unit that stays put is blocked
+			auto game = MakeEmptyGame();
+			UnitID a = PlaceUnit(*game, {10, 10});
+			UnitID b = PlaceUnit(*game, {11, 10});
+			std::vector<Action_Intent> intents{MoveIntent(a, {11, 10})};
+			game->ResolveIntents(intents);
+			bool success = intents[0].result == Action_Result::Retry
+				&& IsAt(*game, a, {10, 10})
+				&& IsAt(*game, b, {11, 10});
+			farb_print(success, "move into a unit that stays put");
+			assert(success);
+		}
+
+		{
+			// a chain moves together when its head enters an empty tile
+			auto game = MakeEmptyGame();
+			UnitID a = PlaceUnit(*game, {10, 10});
+			UnitID b = PlaceUnit(*game, {11, 10});
+			std::vector<Action_Intent> intents{
+				MoveIntent(a, {11, 10}),
+				MoveIntent(b, {12, 10}),
+			};
+			game->ResolveIntents(intents);
+			bool success = intents[0].result == Action_Result::Success
+				&& intents[1].result == Action_Result::Success
+				&& IsAt(*game, a, {11, 10})
+				&& IsAt(*game, b, {12, 10});
+			farb_print(success, "chain of moves into an empty tile");
+			assert(success);
+		}
+
+		{
+			auto game = MakeEmptyGame();
+			UnitID a = PlaceUnit(*game, {10, 10});
+			UnitID b = PlaceUnit(*game, {11, 10});
+			std::vector<Action_Intent> intents{
+				MoveIntent(a, {11, 10}),
+				MoveIntent(b, {10, 10}),
+			};
+			game->ResolveIntents(intents);
+			bool success = intents[0].result == Action_Result::Success
+				&& intents[1].result == Action_Result::Success
+				&& IsAt(*game, a, {11, 10})
+				&& IsAt(*game, b, {10, 10});
+			farb_print(success, "two units swapping");
+			assert(success);
+		}
+
+		{
+			auto game = MakeEmptyGame();
+			UnitID a = PlaceUnit(*game, {10, 10});
+			UnitID b = PlaceUnit(*game, {11, 10});
+			UnitID c = PlaceUnit(*game, {11, 11});
+			std::vector<Action_Intent> intents{
+				MoveIntent(a, {11, 10}),
+				MoveIntent(b, {11, 11}),
+				MoveIntent(c, {10, 10}),
+			};
+			game->ResolveIntents(intents);
+			bool success = intents[0].result == Action_Result::Success
+				&& intents[1].result == Action_Result::Success
+				&& intents[2].result == Action_Result::Success
+				&& IsAt(*game, a, {11, 10})
+				&& IsAt(*game, b, {11, 11})
+				&& IsAt(*game, c, {10, 10});
+			farb_print(success, "cycle of three moves");
+			assert(success);
+		}
+
+		{
+			// a unit outside the cycle claiming one of its tiles loses to the
+			// lower id, so the cycle still moves and the outsider waits
+			auto game = MakeEmptyGame();
+			UnitID a = PlaceUnit(*game, {10, 10});
+			UnitID b = PlaceUnit(*game, {11, 10});
+			UnitID c = PlaceUnit(*game, {12, 10});
+			std::vector<Action_Intent> intents{
+				MoveIntent(a, {11, 10}),
+				MoveIntent(b, {10, 10}),
+				MoveIntent(c, {11, 10}),
+			};
+			game->ResolveIntents(intents);
+			bool success = intents[0].result == Action_Result::Success
+				&& intents[1].result == Action_Result::Success
+				&& intents[2].result == Action_Result::Retry
+				&& IsAt(*game, a, {11, 10})
+				&& IsAt(*game, b, {10, 10})
+				&& IsAt(*game, c, {12, 10});
+			farb_print(success, "swap with an outside claim on one tile");
+			assert(success);
+		}
+
+		return true;
+	}
+};
+
+#endif // TEST_RESOLVE_INTENTS_HPP
@@ -0,0 +1,144 @@
+#ifndef TEST_SAVE_LOAD_HPP
+#define TEST_SAVE_LOAD_HPP
+
+#include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "../../../farb/tests/RegisterTest.hpp"
+#include "../../src/game/Game.h"
+#include "../../src/game/Save_File.h"
+
+using namespace Farb;
+
+using namespace Farb::Tests;
+
+using namespace Brushlink;
+
+// a small match part way through, with units still carrying out a move
+std::unique_ptr<Game> MakeMovingGame()
+{
+	GameSettings settings = GameSettings::default_settings;
+	settings.world_settings.width = 64;
+	settings.world_settings.height = 64;
+	settings.world_settings.starting_locations = {{10, 10}, {50, 50}};
+	settings.seed = 3;
+	auto game = std::make_unique<Game>(settings);
+	game->Initialize();
+	for (int i = 0; i < 20; i++)
+	{
+		game->Tick();
+	}
+	Issued_Command move{PlayerID{0}, Issued_Command_Type::Move, {}, Point{40, 30}};
+	for (const Unit & unit : std::as_const(game->world.units))
+	{
+		if (unit.player == move.player)
+		{
+			move.actors.push_back(unit.id);
+		}
+	}
+	std::sort(move.actors.begin(), move.actors.end(), [](UnitID a, UnitID b)
+	{
+		return a.value < b.value;
+	});
+	game->Issue(move);
+	for (int i = 0; i < 5; i++)
+	{
+		game->Tick();
+	}
+	return game;
+}
+
+// where the section's bytes start in a save, nullptr if it has none or it's empty
+uint8_t * FindSaveSection(std::vector<uint8_t> & state, Save_Section_Type type)
+{
+	Save_Header header;
+	std::memcpy(&header, state.data(), sizeof(header));
+	const Save_Section * sections = reinterpret_cast<const Save_Section *>(state.data() + sizeof(header));
+	for (uint32_t i = 0; i < header.section_count; i++)
+	{
+		if (sections[i].type == type && sections[i].size > 0)
+		{
+			return state.data() + sections[i].offset;
+		}
+	}
+	return nullptr;
+}
+
+class TestSaveLoad : public ITest
+{
+public:
+	virtual bool RunTests() const override
+	{
+		std::cout << "Save and Load" << std::endl;
+
+		{
+			// a loaded game carries on exactly as the one it was saved from
+			auto game = MakeMovingGame();
+			std::vector<uint8_t> state = game->SaveState();
+			auto loaded = Game::LoadState(state.data(), state.size());
+			assert(!loaded.IsError());
+			std::unique_ptr<Game> & copy = loaded.GetValue();
+			bool success = copy->tick == game->tick
+				&& copy->world.units.Count() == game->world.units.Count()
+				&& copy->GetStateHash() == game->GetStateHash();
+			for (int i = 0; i < 100 && success; i++)
+			{
+				game->Tick();
+				copy->Tick();
+				success = copy->GetStateHash() == game->GetStateHash();
+			}
+			farb_print(success, "save, load and tick 100 times");
+			assert(success);
+		}
+
+		{
+			// a unit value that was changed after saving doesn't match the saved hash
+			auto game = MakeMovingGame();
+			std::vector<uint8_t> state = game->SaveState();
+			uint8_t * units = FindSaveSection(state, Save_Section_Type::Units);
+			if (units != nullptr)
+			{
+				reinterpret_cast<Saved_Unit *>(units)->energy += 1;
+			}
+			auto loaded = Game::LoadState(state.data(), state.size());
+			bool success = units != nullptr && loaded.IsError();
+			farb_print(success, "changed unit energy is caught by the hash");
+			assert(success);
+		}
+
+		{
+			// the hash doesn't cover timers, they're range checked instead
+			auto game = MakeMovingGame();
+			std::vector<uint8_t> state = game->SaveState();
+			uint8_t * units = FindSaveSection(state, Save_Section_Type::Units);
+			if (units != nullptr)
+			{
+				reinterpret_cast<Saved_Unit *>(units)->ready_tick = game->tick.value + 1000000;
+			}
+			auto loaded = Game::LoadState(state.data(), state.size());
+			bool success = units != nullptr && loaded.IsError();
+			farb_print(success, "a ready tick past any action's duration is rejected");
+			assert(success);
+		}
+
+		{
+			auto game = MakeMovingGame();
+			std::vector<uint8_t> state = game->SaveState();
+			uint8_t * events = FindSaveSection(state, Save_Section_Type::Events);
+			if (events != nullptr)
+			{
+				reinterpret_cast<Game_Event *>(events)->type = static_cast<Event_Type>(event_type_count);
+			}
+			auto loaded = Game::LoadState(state.data(), state.size());
+			bool success = events != nullptr && loaded.IsError();
+			farb_print(success, "an event type past the last one is rejected");
+			assert(success);
+		}
+
+		return true;
+	}
+};
+
+#endif // TEST_SAVE_LOAD_HPP
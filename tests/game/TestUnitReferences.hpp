@@ -0,0 +1,127 @@
+#ifndef TEST_UNIT_REFERENCES_HPP
+#define TEST_UNIT_REFERENCES_HPP
+
+#include <assert.h>
+
+#include "../../../farb/tests/RegisterTest.hpp"
+#include "../../src/command/Context.h"
+#include "../../src/game/Game.h"
+
+using namespace Farb;
+
+using namespace Farb::Tests;
+
+using namespace Brushlink;
+
+class TestUnitReferences : public ITest
+{
+public:
+	virtual bool RunTests() const override
+	{
+		std::cout << "Unit References" << std::endl;
+
+		GameSettings settings = GameSettings::default_settings;
+		settings.world_settings.width = 64;
+		settings.world_settings.height = 64;
+		settings.world_settings.starting_locations = {{5, 5}, {50, 50}};
+		settings.starting_units.clear();
+		Game game{settings};
+		game.Initialize();
+		auto Place = [&](Point position)
+		{
+			auto result = game.SpawnUnit(PlayerID{0}, Unit_Type::Attacker, position);
+			assert(!result.IsError());
+			return result.GetValue();
+		};
+		UnitID dying = Place({10, 10});
+		UnitID living = Place({12, 10});
+
+		Player & player = game.players.at(PlayerID{0});
+		Command::Context & context = player.root_command_context;
+		Number group{1};
+		ValueName plain{"plain"};
+		ValueName grouped{"grouped"};
+		ValueName replaced{"replaced"};
+		ValueName replacement{"replacement"};
+
+		player.AddToCommandGroup(group, dying);
+		player.AddToCommandGroup(group, living);
+		assert(!context.SetGlobal(plain, {dying, living}).IsError());
+		assert(!context.SetGlobal(grouped, {Unit_Group{{dying, living}}}).IsError());
+		// overwritten, so dying is no longer referenced by it
+		assert(!context.SetGlobal(replaced, {dying}).IsError());
+		assert(!context.SetGlobal(replaced, {living}).IsError());
+		assert(!context.SetGlobal(replacement, {living}).IsError());
+		assert(!context.SetGlobal(replacement, {dying}).IsError());
+
+		{
+			bool success = player.unit_references.at(dying).groups.size() == 1
+				&& player.unit_references.at(dying).values.size() == 3
+				&& player.unit_references.at(dying).values.count(replaced) == 0;
+			farb_print(success, "an overwritten global drops its unit references");
+			assert(success);
+		}
+
+		game.KillUnit(dying);
+		game.RemoveDeadUnits();
+
+		auto & values = context.values;
+		auto Holds = [](const std::vector<Command::Variant> & value, UnitID id)
+		{
+			for (auto & element : value)
+			{
+				if (auto * found = std::get_if<UnitID>(&element))
+				{
+					if (*found == id)
+					{
+						return true;
+					}
+				}
+				else if (auto * members = std::get_if<Unit_Group>(&element))
+				{
+					if (members->members.count(id) != 0)
+					{
+						return true;
+					}
+				}
+			}
+			return false;
+		};
+
+		{
+			bool success = player.command_groups.at(group).members.count(dying) == 0
+				&& player.command_groups.at(group).members.count(living) == 1;
+			farb_print(success, "a dead unit is removed from its command group");
+			assert(success);
+		}
+
+		{
+			bool success = !Holds(values.at(plain), dying)
+				&& Holds(values.at(plain), living)
+				&& !Holds(values.at(grouped), dying)
+				&& Holds(values.at(grouped), living)
+				&& !Holds(values.at(replacement), dying)
+				&& Holds(values.at(replaced), living);
+			farb_print(success, "a dead unit is removed from globals and groups in globals");
+			assert(success);
+		}
+
+		{
+			bool success = player.unit_references.count(dying) == 0;
+			farb_print(success, "a dead unit has no references left");
+			assert(success);
+		}
+
+		{
+			game.KillUnit(living);
+			game.RemoveDeadUnits();
+			bool success = player.unit_references.empty();
+			farb_print(success, "unit references are empty once every unit is dead");
+			assert(success);
+		}
+
+		return true;
+	}
+};
+
+#endif // TEST_UNIT_REFERENCES_HPP
@@ -0,0 +1,98 @@
+#ifndef TEST_UNIT_STORE_HPP
+#define TEST_UNIT_STORE_HPP
+
+#include <assert.h>
+
+#include "../../../farb/tests/RegisterTest.hpp"
+#include "../../src/game/Unit_Store.h"
+
+using namespace Farb;
+
+using namespace Farb::Tests;
+
+using namespace Brushlink;
+
+UnitID AddUnit(Unit_Store & store)
+{
+	Unit * added = store.Add(Unit{});
+	assert(added != nullptr);
+	return added->id;
+}
+
+class TestUnitStore : public ITest
+{
+public:
+	virtual bool RunTests() const override
+	{
+		std::cout << "Unit Store" << std::endl;
+
+		{
+			// removing swaps the last unit into the hole, ids still find their unit
+			Unit_Store store;
+			UnitID a = AddUnit(store);
+			UnitID b = AddUnit(store);
+			UnitID c = AddUnit(store);
+			store.Remove(a);
+			bool success = store.Count() == 2
+				&& store.Find(a) == nullptr
+				&& store.Find(b) != nullptr && store.Find(b)->id == b
+				&& store.Find(c) != nullptr && store.Find(c)->id == c
+				&& store.Find(c)->slot == store.SlotOf(c);
+			farb_print(success, "remove keeps the other ids valid");
+			assert(success);
+		}
+
+		{
+			// a reused handle gets a new generation, so the old id stays dead
+			Unit_Store store;
+			UnitID a = AddUnit(store);
+			store.Remove(a);
+			UnitID b = AddUnit(store);
+			bool success = Unit_Store::IndexOf(a) == Unit_Store::IndexOf(b)
+				&& a != b
+				&& store.Find(a) == nullptr
+				&& store.Find(b) != nullptr;
+			farb_print(success, "stale id after handle reuse");
+			assert(success);
+		}
+
+		{
+			// handles are reused in the order they were freed
+			Unit_Store store;
+			UnitID a = AddUnit(store);
+			UnitID b = AddUnit(store);
+			store.Remove(a);
+			store.Remove(b);
+			UnitID c = AddUnit(store);
+			UnitID d = AddUnit(store);
+			bool success = Unit_Store::IndexOf(c) == Unit_Store::IndexOf(a)
+				&& Unit_Store::IndexOf(d) == Unit_Store::IndexOf(b);
+			farb_print(success, "handles reused first in, first out");
+			assert(success);
+		}
+
+		{
+			// churning one handle through every generation retires it
+			// instead of handing out an id equal to the first one again
+			Unit_Store store;
+			UnitID first = AddUnit(store);
+			UnitID id = first;
+			bool aliased = false;
+			for (int i = 0; i <= Unit_Store::generation_mask + 1; i++)
+			{
+				store.Remove(id);
+				id = AddUnit(store);
+				aliased = aliased || id == first;
+			}
+			bool success = !aliased
+				&& store.Find(first) == nullptr
+				&& Unit_Store::IndexOf(id) != Unit_Store::IndexOf(first);
+			farb_print(success, "handle retired when its generation wraps");
+			assert(success);
+		}
+
+		return true;
+	}
+};
+
+#endif // TEST_UNIT_STORE_HPP